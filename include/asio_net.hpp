@@ -13,6 +13,14 @@
 #include "asio_net/tcp_client.hpp"
 #include "asio_net/tcp_server.hpp"
 
+// tcp striped
+#include "asio_net/striped_client.hpp"
+#include "asio_net/striped_server.hpp"
+
+// client pool
+#include "asio_net/rpc_client_pool.hpp"
+#include "asio_net/tcp_client_pool.hpp"
+
 // udp
 #include "asio_net/udp_client.hpp"
 #include "asio_net/udp_server.hpp"
@@ -1,11 +1,36 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <string>
 
+#include "detail/busy_poll.hpp"
+#include "detail/token_bucket.hpp"
 #include "rpc_core/rpc.hpp"
 
 namespace asio_net {
 
+using token_bucket = detail::token_bucket;
+using busy_poll_config = detail::busy_poll_config;
+
+/**
+ * socket tuning profile, only fill the socket options not set
+ */
+enum class tcp_profile {
+  none,
+  low_latency,  // nodelay, quickack, busy poll, small notsent lowat, tos lowdelay
+  bulk,         // bbr congestion, tos throughput
+};
+
+/**
+ * what to do when offline queue of client is full, @see tcp_config::offline_queue_messages
+ */
+enum class offline_policy {
+  drop_oldest,  // evict the oldest queued message
+  drop_newest,  // discard the message being sent
+  reject,       // discard the message being sent and not count it as dropped, caller handles by return value of send
+};
+
 struct tcp_config {
   bool auto_pack = false;
   bool enable_ipv6 = false;
@@ -16,11 +41,123 @@ struct tcp_config {
   uint32_t socket_send_buffer_size = UINT32_MAX;
   uint32_t socket_recv_buffer_size = UINT32_MAX;
 
+  // socket tuning, UINT32_MAX/empty: not set, failed option will be ignored with a warning
+  // NOTICE: some options are linux only, and not work for domain socket
+  tcp_profile profile = tcp_profile::none;
+  uint32_t socket_nodelay = UINT32_MAX;               // TCP_NODELAY, 0/1
+  uint32_t socket_quickack = UINT32_MAX;              // TCP_QUICKACK, 0/1, linux only
+  uint32_t socket_busy_poll_us = UINT32_MAX;          // SO_BUSY_POLL, linux only, may need CAP_NET_ADMIN
+  std::string socket_congestion;                      // TCP_CONGESTION, e.g. "bbr", "cubic", linux only
+  uint32_t socket_notsent_lowat = UINT32_MAX;         // TCP_NOTSENT_LOWAT, bytes
+  uint32_t socket_priority = UINT32_MAX;              // SO_PRIORITY, linux only
+  uint32_t socket_tos = UINT32_MAX;                   // IP_TOS or IPV6_TCLASS
+  uint32_t socket_keepalive = UINT32_MAX;             // SO_KEEPALIVE, 0/1
+  uint32_t socket_keepalive_idle_s = UINT32_MAX;      // TCP_KEEPIDLE
+  uint32_t socket_keepalive_interval_s = UINT32_MAX;  // TCP_KEEPINTVL
+  uint32_t socket_keepalive_count = UINT32_MAX;       // TCP_KEEPCNT
+
+  // server only, SO_REUSEPORT, with io_context_pool each pool thread owns an acceptor on the same port
+  // NOTICE: not work for domain socket and windows
+  bool reuse_port = false;
+
+  // server only, stop accepting when alive sessions reach it, connections will wait in backlog
+  // ssl sessions are counted from accept, so handshakes are bounded too
+  // NOTICE: session is counted until destroyed, closed sessions still held by user keep counting
+  uint32_t max_connections = UINT32_MAX;
+
+  // server only, memory of closed sessions kept for reuse, saves allocation for short connections, 0: disable
+  uint32_t session_pool_size = 0;
+
+  // server only, admission control by source ip, checked before session allocated, rejected connection closed at once
+  // NOTICE: not work for domain socket
+  uint32_t max_connections_per_ip = UINT32_MAX;  // alive connections per ip
+  uint32_t accept_rate_per_ip = 0;               // accepts per second per ip, token bucket, 0: unlimited
+  uint32_t accept_burst_per_ip = 0;              // bucket size, 0: same as accept_rate_per_ip
+
+  // server only, accept tuning
+  uint32_t accept_backlog = UINT32_MAX;         // listen backlog, UINT32_MAX: SOMAXCONN
+  uint32_t accept_pending = 1;                  // concurrent async_accept per acceptor
+  uint32_t accept_retry_min_ms = 10;            // retry backoff after accept error, e.g. EMFILE
+  uint32_t accept_retry_max_ms = 1000;
+  uint32_t socket_defer_accept_s = UINT32_MAX;  // TCP_DEFER_ACCEPT, accept after data arrived, linux only
+  uint32_t socket_fastopen = UINT32_MAX;        // TCP_FASTOPEN, queue length of pending fastopen requests
+
+  // server only, with io_context_pool, move sessions from the busiest pool thread to the idlest by traffic
+  // NOTICE: posix only, not work for ssl, @see tcp_server_t::migrate
+  uint32_t rebalance_interval_ms = 0;          // traffic sample interval, one session moved at most per interval, 0: disable
+  uint32_t rebalance_min_bytes = 1024 * 1024;  // min traffic difference between threads in an interval to move
+
+  // client only, connect and reconnect, @see tcp_client_t::set_reconnect
+  uint32_t reconnect_max_ms = 0;                  // interval doubles after each failure up to it, 0: fixed interval
+  uint32_t reconnect_jitter_percent = 0;          // randomize each interval by up to N%, spread reconnects of a fleet
+  uint32_t dns_cache_ttl_ms = 0;                  // reuse resolved endpoints within ttl, shared in process, 0: resolve every open
+  uint32_t happy_eyeballs_delay_ms = UINT32_MAX;  // next address tried if previous not connected in it, e.g. 250, UINT32_MAX: one by one
+  // TCP_FASTOPEN_CONNECT, first message rides on SYN once cookie cached, linux only
+  // NOTICE: only used when one endpoint resolved, connect completes before SYN sent, so failover between endpoints needs a real connect
+  bool socket_fastopen_connect = false;
+
+  // client only, keep messages sent while disconnected, sent in order once reconnected, before on_open
+  // NOTICE: not used by rpc_client, rpc calls are bound to the connection
+  uint32_t offline_queue_messages = 0;                                // max messages queued, 0: disable, messages sent while closed are lost
+  uint32_t offline_queue_bytes = UINT32_MAX;                          // max bytes queued
+  offline_policy offline_queue_policy = offline_policy::drop_oldest;  // when full
+
+  // ssl only, resume the session of last connection to skip the full handshake on reconnect
+  // client: offers the session saved from last connection, server: enables session cache and tickets on its ssl context
+  bool ssl_session_resumption = false;
+
+  // read option
+  // wait for readable before committing a read buffer, idle connections hold no buffer.
+  // when auto_pack disable, data will be read into a buffer shared by the io thread.
+  // NOTICE: not work for ssl
+  bool lazy_read = false;
+
+  // read flow control, report backlog by tcp_channel_t::set_read_backlog
+  uint32_t read_backlog_high = UINT32_MAX;  // pause read when backlog >= read_backlog_high, UINT32_MAX: disable
+  uint32_t read_backlog_low = 0;            // resume read when backlog <= read_backlog_low
+
+  // read fairness, yield io thread by asio::post after reading continuously, avoid starve other sessions
+  uint32_t read_budget_messages = 0;  // messages(auto_pack) or reads(raw) back-to-back before yield, 0: unlimited
+  uint32_t read_budget_bytes = 0;     // bytes back-to-back before yield, 0: unlimited
+
+  // bandwidth shaping by token bucket, bytes per second, 0: unlimited
+  uint64_t send_rate_limit = 0;
+  uint64_t send_rate_burst = 0;  // bucket size, 0: same as send_rate_limit
+  uint64_t recv_rate_limit = 0;
+  uint64_t recv_rate_burst = 0;  // bucket size, 0: same as recv_rate_limit
+  // shared by all channels created with this config, e.g. all sessions of a tcp_server
+  std::shared_ptr<token_bucket> shared_send_bucket;
+  std::shared_ptr<token_bucket> shared_recv_bucket;
+
+  // sample kernel tcp info into tcp_stats periodically, 0: disable, @see tcp_channel_t::tcp_info
+  uint32_t tcp_info_interval_ms = 0;
+
   void init() {
     // when auto_pack disable, max_body_size means buffer size, default is 1024 bytes
     if ((!auto_pack) && (max_body_size == UINT32_MAX)) {
       max_body_size = 1024;
     }
+
+    // profile only fill the socket options not set
+    auto set_default = [](uint32_t& option, uint32_t value) {
+      if (option == UINT32_MAX) option = value;
+    };
+    switch (profile) {
+      case tcp_profile::none:
+        break;
+      case tcp_profile::low_latency:
+        set_default(socket_nodelay, 1);
+        set_default(socket_quickack, 1);
+        set_default(socket_busy_poll_us, 50);
+        set_default(socket_notsent_lowat, 16 * 1024);
+        set_default(socket_tos, 0x10);  // IPTOS_LOWDELAY
+        break;
+      case tcp_profile::bulk:
+        set_default(socket_nodelay, 0);
+        set_default(socket_tos, 0x08);  // IPTOS_THROUGHPUT
+        if (socket_congestion.empty()) socket_congestion = "bbr";
+        break;
+    }
   }
 };
 
@@ -39,16 +176,134 @@ struct rpc_config {
   uint32_t socket_send_buffer_size = UINT32_MAX;
   uint32_t socket_recv_buffer_size = UINT32_MAX;
 
+  // socket tuning, UINT32_MAX/empty: not set, @see tcp_config
+  tcp_profile profile = tcp_profile::none;
+  uint32_t socket_nodelay = UINT32_MAX;               // TCP_NODELAY, 0/1
+  uint32_t socket_quickack = UINT32_MAX;              // TCP_QUICKACK, 0/1, linux only
+  uint32_t socket_busy_poll_us = UINT32_MAX;          // SO_BUSY_POLL, linux only
+  std::string socket_congestion;                      // TCP_CONGESTION, linux only
+  uint32_t socket_notsent_lowat = UINT32_MAX;         // TCP_NOTSENT_LOWAT, bytes
+  uint32_t socket_priority = UINT32_MAX;              // SO_PRIORITY, linux only
+  uint32_t socket_tos = UINT32_MAX;                   // IP_TOS or IPV6_TCLASS
+  uint32_t socket_keepalive = UINT32_MAX;             // SO_KEEPALIVE, 0/1
+  uint32_t socket_keepalive_idle_s = UINT32_MAX;      // TCP_KEEPIDLE
+  uint32_t socket_keepalive_interval_s = UINT32_MAX;  // TCP_KEEPINTVL
+  uint32_t socket_keepalive_count = UINT32_MAX;       // TCP_KEEPCNT
+
+  // server only, @see tcp_config
+  bool reuse_port = false;                       // SO_REUSEPORT, acceptor per pool thread
+  uint32_t max_connections = UINT32_MAX;         // stop accepting when alive sessions reach it
+  uint32_t session_pool_size = 0;                // closed sessions kept for reuse, also used by rpc_session of rpc_server
+  uint32_t max_connections_per_ip = UINT32_MAX;  // alive connections per ip
+  uint32_t accept_rate_per_ip = 0;               // accepts per second per ip, 0: unlimited
+  uint32_t accept_burst_per_ip = 0;              // 0: same as accept_rate_per_ip
+  uint32_t accept_backlog = UINT32_MAX;          // listen backlog, UINT32_MAX: SOMAXCONN
+  uint32_t accept_pending = 1;                   // concurrent async_accept per acceptor
+  uint32_t accept_retry_min_ms = 10;             // retry backoff after accept error, e.g. EMFILE
+  uint32_t accept_retry_max_ms = 1000;           // retry backoff cap
+  uint32_t socket_defer_accept_s = UINT32_MAX;   // TCP_DEFER_ACCEPT, linux only
+  uint32_t socket_fastopen = UINT32_MAX;         // TCP_FASTOPEN, queue length
+  uint32_t rebalance_interval_ms = 0;            // move sessions between pool threads by traffic, 0: disable
+  uint32_t rebalance_min_bytes = 1024 * 1024;    // min traffic difference to move
+
+  // client only, @see tcp_config
+  // NOTICE: offline_queue_* is not available, rpc calls are bound to the connection
+  uint32_t reconnect_max_ms = 0;                  // reconnect backoff cap, 0: fixed interval
+  uint32_t reconnect_jitter_percent = 0;          // randomize each reconnect interval by up to N%
+  uint32_t dns_cache_ttl_ms = 0;                  // reuse resolved endpoints within ttl, 0: resolve every open
+  uint32_t happy_eyeballs_delay_ms = UINT32_MAX;  // next address tried after it, UINT32_MAX: one by one
+  bool socket_fastopen_connect = false;           // TCP_FASTOPEN_CONNECT, one endpoint resolved only, linux only
+
+  // ssl only, @see tcp_config
+  bool ssl_session_resumption = false;
+
+  // read option, @see tcp_config
+  bool lazy_read = false;                   // no read buffer held by idle connections, not work for ssl
+  uint32_t read_backlog_high = UINT32_MAX;  // pause read when backlog >= it, UINT32_MAX: disable
+  uint32_t read_backlog_low = 0;            // resume read when backlog <= it
+  uint32_t read_budget_messages = 0;        // messages back-to-back before yield, 0: unlimited
+  uint32_t read_budget_bytes = 0;           // bytes back-to-back before yield, 0: unlimited
+
+  // bandwidth shaping, bytes per second, 0: unlimited, @see tcp_config
+  uint64_t send_rate_limit = 0;
+  uint64_t send_rate_burst = 0;  // 0: same as send_rate_limit
+  uint64_t recv_rate_limit = 0;
+  uint64_t recv_rate_burst = 0;  // 0: same as recv_rate_limit
+  std::shared_ptr<token_bucket> shared_send_bucket;
+  std::shared_ptr<token_bucket> shared_recv_bucket;
+
+  // sample kernel tcp info into tcp_stats periodically, 0: disable
+  uint32_t tcp_info_interval_ms = 0;
+
   tcp_config to_tcp_config() {
     return {.auto_pack = true,
             .enable_ipv6 = enable_ipv6,
             .max_body_size = max_body_size,
             .max_send_buffer_size = max_send_buffer_size,
             .socket_send_buffer_size = socket_send_buffer_size,
-            .socket_recv_buffer_size = socket_recv_buffer_size};
+            .socket_recv_buffer_size = socket_recv_buffer_size,
+            .profile = profile,
+            .socket_nodelay = socket_nodelay,
+            .socket_quickack = socket_quickack,
+            .socket_busy_poll_us = socket_busy_poll_us,
+            .socket_congestion = socket_congestion,
+            .socket_notsent_lowat = socket_notsent_lowat,
+            .socket_priority = socket_priority,
+            .socket_tos = socket_tos,
+            .socket_keepalive = socket_keepalive,
+            .socket_keepalive_idle_s = socket_keepalive_idle_s,
+            .socket_keepalive_interval_s = socket_keepalive_interval_s,
+            .socket_keepalive_count = socket_keepalive_count,
+            .reuse_port = reuse_port,
+            .max_connections = max_connections,
+            .session_pool_size = session_pool_size,
+            .max_connections_per_ip = max_connections_per_ip,
+            .accept_rate_per_ip = accept_rate_per_ip,
+            .accept_burst_per_ip = accept_burst_per_ip,
+            .accept_backlog = accept_backlog,
+            .accept_pending = accept_pending,
+            .accept_retry_min_ms = accept_retry_min_ms,
+            .accept_retry_max_ms = accept_retry_max_ms,
+            .socket_defer_accept_s = socket_defer_accept_s,
+            .socket_fastopen = socket_fastopen,
+            .rebalance_interval_ms = rebalance_interval_ms,
+            .rebalance_min_bytes = rebalance_min_bytes,
+            .reconnect_max_ms = reconnect_max_ms,
+            .reconnect_jitter_percent = reconnect_jitter_percent,
+            .dns_cache_ttl_ms = dns_cache_ttl_ms,
+            .happy_eyeballs_delay_ms = happy_eyeballs_delay_ms,
+            .socket_fastopen_connect = socket_fastopen_connect,
+            .ssl_session_resumption = ssl_session_resumption,
+            .lazy_read = lazy_read,
+            .read_backlog_high = read_backlog_high,
+            .read_backlog_low = read_backlog_low,
+            .read_budget_messages = read_budget_messages,
+            .read_budget_bytes = read_budget_bytes,
+            .send_rate_limit = send_rate_limit,
+            .send_rate_burst = send_rate_burst,
+            .recv_rate_limit = recv_rate_limit,
+            .recv_rate_burst = recv_rate_burst,
+            .shared_send_bucket = shared_send_bucket,
+            .shared_recv_bucket = shared_recv_bucket,
+            .tcp_info_interval_ms = tcp_info_interval_ms};
   }
 };
 
+struct striped_config {
+  uint32_t stripe_num = 4;          // client: connections per channel, server: max connections per channel
+  uint32_t chunk_size = 64 * 1024;  // message larger than chunk_size will be split into chunks
+
+  // reassembly limits of received chunks, exceeding closes the channel
+  uint32_t recv_window = 64;                    // chunks ahead of the next in order one, per stripe
+  uint32_t max_recv_buffer = 64 * 1024 * 1024;  // bytes of chunks waiting for a previous one
+  uint32_t max_message_size = UINT32_MAX;       // bytes of a reassembled message, UINT32_MAX: unlimited like max_body_size
+};
+
+struct client_pool_config {
+  uint32_t pool_size = 4;        // connections to the same server, all opened by open
+  uint32_t reconnect_ms = 1000;  // each connection reconnects on its own, 0: disable
+};
+
 struct serial_config {
   // device
   std::string device;
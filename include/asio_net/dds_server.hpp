@@ -1,6 +1,7 @@
 #pragma once
 
 #include "detail/dds_server_t.hpp"
+#include "io_context_pool.hpp"
 
 namespace asio_net {
 
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "asio.hpp"
+#include "noncopyable.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * admission control of server by source ip, checked after accept and before session allocated
+ * each ip has connection count and accept token bucket, idle entries age out
+ * threadsafe, shared by acceptors on pool threads
+ */
+class accept_limiter : private noncopyable, public std::enable_shared_from_this<accept_limiter> {
+  using clock = std::chrono::steady_clock;
+  using key = std::array<unsigned char, 16>;
+
+ public:
+  /**
+   * @param max_per_ip alive connections per ip, UINT32_MAX: unlimited
+   * @param rate accepts per second per ip, 0: unlimited
+   * @param burst bucket size, 0: same as rate
+   */
+  accept_limiter(uint32_t max_per_ip, uint32_t rate, uint32_t burst)
+      : max_per_ip_(max_per_ip), rate_(rate), burst_(burst ? burst : rate) {}
+
+  /**
+   * @return token hold by session, connection counted until released. nullptr: rejected
+   */
+  std::shared_ptr<void> admit(const asio::ip::address& address) {
+    auto now = clock::now();
+    auto k = to_key(address);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sweep(now);
+    auto it = entries_.find(k);
+    if (it == entries_.end()) {
+      it = entries_.emplace(k, entry{0, (double)burst_, now}).first;
+    }
+    auto& e = it->second;
+    if (rate_) {
+      e.tokens = std::min((double)burst_, e.tokens + std::chrono::duration<double>(now - e.last).count() * rate_);
+    }
+    e.last = now;
+    if (e.connections >= max_per_ip_) return nullptr;
+    if (rate_) {
+      if (e.tokens < 1) return nullptr;
+      e.tokens -= 1;
+    }
+    ++e.connections;
+    return {this, [self = shared_from_this(), k](void*) {
+              self->release(k);
+            }};
+  }
+
+  /**
+   * tracked ips
+   */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+ private:
+  static key to_key(const asio::ip::address& address) {
+    key k{};
+    if (address.is_v4()) {
+      auto bytes = address.to_v4().to_bytes();
+      std::memcpy(k.data() + 12, bytes.data(), bytes.size());
+    } else {
+      auto bytes = address.to_v6().to_bytes();
+      std::memcpy(k.data(), bytes.data(), bytes.size());
+    }
+    return k;
+  }
+
+  struct key_hash {
+    size_t operator()(const key& k) const {
+      uint64_t a, b;
+      std::memcpy(&a, k.data(), 8);
+      std::memcpy(&b, k.data() + 8, 8);
+      return std::hash<uint64_t>()(a * 0x9E3779B97F4A7C15ull ^ b);
+    }
+  };
+
+  void release(const key& k) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(k);
+    if (it == entries_.end()) return;
+    --it->second.connections;
+    // bucket need time to refill, leave it to sweep
+    if (it->second.connections == 0 && !rate_) entries_.erase(it);
+  }
+
+  /**
+   * remove ips without connection and with full bucket, a few buckets of the table per call
+   * bounded work under the lock on accept path, and the table is still swept faster than one new ip per admit
+   */
+  void sweep(clock::time_point now) {
+    static const size_t sweep_buckets = 4;
+    auto refill = std::chrono::duration<double>(rate_ ? (double)burst_ / rate_ : 0);
+    for (size_t n = 0; n < sweep_buckets; ++n) {
+      // cursor may skip or repeat buckets after rehash, entries are still visited in later rounds
+      if (sweep_bucket_ >= entries_.bucket_count()) sweep_bucket_ = 0;
+      auto bucket = sweep_bucket_++;
+      for (auto it = entries_.begin(bucket); it != entries_.end(bucket);) {
+        bool expired = it->second.connections == 0 && now - it->second.last >= refill;
+        auto k = it->first;
+        ++it;
+        if (expired) entries_.erase(k);
+      }
+    }
+  }
+
+ private:
+  struct entry {
+    uint32_t connections;
+    double tokens;
+    clock::time_point last;
+  };
+
+  const uint32_t max_per_ip_;
+  const uint32_t rate_;
+  const uint32_t burst_;
+  size_t sweep_bucket_ = 0;
+  std::unordered_map<key, entry, key_hash> entries_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "noncopyable.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * free list of same size memory blocks, e.g. sessions allocated by std::allocate_shared
+ * block size is decided by the first deallocate, other sizes go to operator new/delete
+ * threadsafe, sessions may be destroyed on pool threads
+ */
+class block_pool : private noncopyable {
+ public:
+  /**
+   * @param capacity max free blocks kept
+   */
+  explicit block_pool(size_t capacity) : capacity_(capacity) {
+    free_.reserve(capacity);
+  }
+
+  ~block_pool() {
+    for (auto block : free_) {
+      ::operator delete(block);
+    }
+  }
+
+  void* allocate(size_t size) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (size == block_size_ && !free_.empty()) {
+        auto block = free_.back();
+        free_.pop_back();
+        return block;
+      }
+    }
+    return ::operator new(size);
+  }
+
+  void deallocate(void* block, size_t size) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (block_size_ == 0) block_size_ = size;
+      if (size == block_size_ && free_.size() < capacity_) {
+        free_.push_back(block);
+        return;
+      }
+    }
+    ::operator delete(block);
+  }
+
+  size_t free_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+  }
+
+ private:
+  const size_t capacity_;
+  size_t block_size_ = 0;
+  std::vector<void*> free_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * one block_pool per io_context, blocks stay on the thread(and numa node) of the io_context which allocated them
+ * threadsafe
+ */
+class block_pool_map : private noncopyable {
+ public:
+  /**
+   * @param capacity max free blocks kept by each block_pool
+   */
+  explicit block_pool_map(size_t capacity) : capacity_(capacity) {}
+
+  std::shared_ptr<block_pool> get(const void* key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& pool = pools_[key];
+    if (!pool) pool = std::make_shared<block_pool>(capacity_);
+    return pool;
+  }
+
+ private:
+  const size_t capacity_;
+  std::unordered_map<const void*, std::shared_ptr<block_pool>> pools_;
+  std::mutex mutex_;
+};
+
+/**
+ * allocator on block_pool, keeps the pool alive until all blocks returned
+ * usage: std::allocate_shared<T>(pool_allocator<T>(pool), args...), object and control block in one block
+ */
+template <typename T>
+struct pool_allocator {
+  using value_type = T;
+
+  explicit pool_allocator(std::shared_ptr<block_pool> pool) : pool(std::move(pool)) {}
+
+  template <typename U>
+  pool_allocator(const pool_allocator<U>& other) : pool(other.pool) {}
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type not supported");
+    return static_cast<T*>(pool->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    pool->deallocate(p, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const pool_allocator<U>& other) const {
+    return pool == other.pool;
+  }
+
+  template <typename U>
+  bool operator!=(const pool_allocator<U>& other) const {
+    return pool != other.pool;
+  }
+
+  std::shared_ptr<block_pool> pool;
+};
+
+/**
+ * allocate from pool if not null
+ */
+template <typename T, typename... Args>
+inline std::shared_ptr<T> make_shared_pooled(const std::shared_ptr<block_pool>& pool, Args&&... args) {
+  if (!pool) return std::make_shared<T>(std::forward<Args>(args)...);
+  return std::allocate_shared<T>(pool_allocator<T>(pool), std::forward<Args>(args)...);
+}
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "asio.hpp"
+#include "thread_option.hpp"
+
+namespace asio_net {
+namespace detail {
+
+struct busy_poll_config {
+  uint32_t spin_us = 50;  // keep polling after the last handler ran before blocking in epoll, UINT32_MAX: never block
+  int cpu = -1;           // pin polling thread to cpu, linux only, -1: not pinned
+};
+
+/**
+ * run io_context until stopped, spin on poll() to skip the wakeup latency of epoll, fall back to blocking when idle
+ * pair with tcp_config.socket_busy_poll_us to also busy poll the nic queue in kernel
+ * NOTICE: burns a whole cpu while spinning, pin it to an isolated cpu and never run two spinners on the same one
+ */
+inline void run_busy_poll(asio::io_context& io_context, busy_poll_config config = {}) {
+  if (config.cpu >= 0) set_thread_affinity({config.cpu});
+  auto work = asio::make_work_guard(io_context);
+  const auto budget = std::chrono::microseconds(config.spin_us);
+  auto idle_since = std::chrono::steady_clock::now();
+  while (!io_context.stopped()) {
+    if (io_context.poll()) {
+      idle_since = std::chrono::steady_clock::now();
+      continue;
+    }
+    if (config.spin_us == UINT32_MAX || std::chrono::steady_clock::now() - idle_since < budget) continue;
+    io_context.run_one();
+    idle_since = std::chrono::steady_clock::now();
+  }
+}
+
+}  // namespace detail
+}  // namespace asio_net
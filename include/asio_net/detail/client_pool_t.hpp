@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../config.hpp"
+#include "io_executor.hpp"
+#include "log.h"
+#include "noncopyable.hpp"
+#include "socket_type.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * keep `pool_size` connections to the same server, each opened at startup and reconnected on its own
+ * requests are balanced to the open connection with least bytes queued, or pinned to one by key to keep order
+ * NOTICE: connections share one strand if executor is concurrent, use the pool on it
+ */
+template <socket_type T, typename Client>
+class client_pool_t : private noncopyable {
+ public:
+  static constexpr size_t npos = SIZE_MAX;
+
+ protected:
+  client_pool_t(io_executor executor, client_pool_config config)
+      : executor_(executor.make_strand()), config_(config), open_(std::max(config.pool_size, 1u), false) {}
+
+ public:
+  /**
+   * open all connections, @see on_open
+   *
+   * @param host A string identifying a location. May be a descriptive name or a numeric address string.
+   * @param port The port to open.
+   */
+  void open(const std::string& host, uint16_t port) {
+    static_assert(T == socket_type::normal || T == socket_type::ssl, "");
+    for (auto& client : clients_) {
+      if (config_.reconnect_ms) client->set_reconnect(config_.reconnect_ms);
+      client->open(host, port);
+    }
+  }
+
+  /**
+   * open all connections to domain socket, @see on_open
+   *
+   * @param endpoint e.g. /tmp/foobar
+   */
+  void open(const std::string& endpoint) {
+    static_assert(T == socket_type::domain, "");
+    for (auto& client : clients_) {
+      if (config_.reconnect_ms) client->set_reconnect(config_.reconnect_ms);
+      client->open(endpoint);
+    }
+  }
+
+  void close() {
+    for (auto& client : clients_) {
+      client->close();
+    }
+  }
+
+  size_t size() const {
+    return clients_.size();
+  }
+
+  size_t open_count() const {
+    return open_count_;
+  }
+
+  bool is_open(size_t index) const {
+    return open_[index];
+  }
+
+  Client& get_client(size_t index) {
+    return *clients_[index];
+  }
+
+  /**
+   * open connection with least bytes queued, ties are taken in turn
+   * @return npos if none open
+   */
+  size_t select() {
+    size_t best = npos;
+    for (size_t n = 0; n < clients_.size(); ++n) {
+      auto i = (next_ + n) % clients_.size();
+      if (!open_[i]) continue;
+      if (best == npos || clients_[i]->send_buffer_size() < clients_[best]->send_buffer_size()) best = i;
+    }
+    if (best != npos) next_ = best + 1;
+    return best;
+  }
+
+  /**
+   * same connection for the same key while it is open, then the next open one
+   * @param key e.g. std::hash of user id
+   * @return npos if none open
+   */
+  size_t select(size_t key) const {
+    for (size_t n = 0; n < clients_.size(); ++n) {
+      auto i = (key + n) % clients_.size();
+      if (open_[i]) return i;
+    }
+    return npos;
+  }
+
+  /**
+   * run io_context until stop, not available for other executors
+   */
+  void run() {
+    auto io_context = executor_.io_context();
+    if (!io_context) {
+      ASIO_NET_LOGE("run: needs io_context");
+      return;
+    }
+    auto work = asio::make_work_guard(*io_context);
+    io_context->run();
+  }
+
+  void stop() {
+    close();
+    if (executor_.io_context()) executor_.io_context()->stop();
+  }
+
+ protected:
+  void set_open(size_t index, bool open) {
+    if (open_[index] == open) return;
+    open_[index] = open;
+    if (!open) {
+      --open_count_;
+      return;
+    }
+    if (++open_count_ == clients_.size() && !warmed_) {
+      warmed_ = true;
+      if (on_open) on_open();
+    }
+  }
+
+ public:
+  // all connections opened for the first time
+  std::function<void()> on_open;
+  std::function<void(std::error_code)> on_open_failed;
+
+ protected:
+  io_executor executor_;
+  client_pool_config config_;
+  std::vector<std::unique_ptr<Client>> clients_;
+
+ private:
+  std::vector<bool> open_;
+  size_t open_count_ = 0;
+  size_t next_ = 0;
+  bool warmed_ = false;
+};
+
+}  // namespace detail
+}  // namespace asio_net
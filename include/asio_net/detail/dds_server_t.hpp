@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -13,19 +14,19 @@ namespace detail {
 template <detail::socket_type T>
 class dds_server_t {
  public:
-  dds_server_t(asio::io_context& io_context, uint16_t port) : server_(io_context, port) {
+  dds_server_t(io_executor executor, uint16_t port) : server_(std::move(executor), port) {
     static_assert(T == detail::socket_type::normal, "");
     init();
   }
 
 #ifdef ASIO_NET_ENABLE_SSL
-  dds_server_t(asio::io_context& io_context, uint16_t port, asio::ssl::context& ssl_context) : server_(io_context, port, ssl_context) {
+  dds_server_t(io_executor executor, uint16_t port, asio::ssl::context& ssl_context) : server_(std::move(executor), port, ssl_context) {
     static_assert(T == detail::socket_type::ssl, "");
     init();
   }
 #endif
 
-  dds_server_t(asio::io_context& io_context, const std::string& endpoint) : server_(io_context, endpoint) {
+  dds_server_t(io_executor executor, const std::string& endpoint) : server_(std::move(executor), endpoint) {
     static_assert(T == detail::socket_type::domain, "");
     init();
   }
@@ -34,6 +35,14 @@ class dds_server_t {
     server_.start(loop);
   }
 
+  /**
+   * @see tcp_server_t::set_io_context_pool
+   * publish to session on other io_context will be dispatched to it
+   */
+  void set_io_context_pool(std::shared_ptr<io_context_pool> pool) {
+    server_.set_io_context_pool(std::move(pool));
+  }
+
  private:
   void init() {
     server_.on_session = [this](const std::weak_ptr<detail::rpc_session_t<T>>& rs) {
@@ -44,6 +53,10 @@ class dds_server_t {
       };
 
       auto rpc = session->rpc;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rpc_session_map_[rpc] = session;
+      }
       rpc->subscribe(cmd_update_topic_list, [this, rpc_wp = dds::rpc_w(rpc)](const std::vector<std::string>& topic_list) {
         update_topic_list(rpc_wp.lock(), topic_list);
       });
@@ -54,17 +67,44 @@ class dds_server_t {
   }
 
   void publish(const dds::Msg& msg, const dds::rpc_w& from_rpc) {
-    auto it = topic_rpc_map_.find(msg.topic);
-    if (it != topic_rpc_map_.cend()) {
+    std::vector<std::shared_ptr<rpc_session_t<T>>> targets;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = topic_rpc_map_.find(msg.topic);
+      if (it == topic_rpc_map_.cend()) return;
       auto from_rpc_sp = from_rpc.lock();
       for (const auto& rpc : it->second) {
         if (rpc == from_rpc_sp) continue;
-        rpc->cmd(cmd_publish)->msg(msg)->retry(-1)->call();
+        auto session = rpc_session_map_[rpc].lock();
+        if (session) targets.push_back(std::move(session));
       }
     }
+    if (targets.empty()) return;
+    auto shared_msg = std::make_shared<dds::Msg>(msg);
+    for (auto& target : targets) {
+      publish_to(std::move(target), shared_msg);
+    }
+  }
+
+  /**
+   * rpc is not threadsafe, call on executor of its session, inline if on the same thread
+   * executor is read when published, session may be migrated
+   */
+  static void publish_to(std::shared_ptr<rpc_session_t<T>> session, std::shared_ptr<dds::Msg> msg) {
+    auto executor = session->get_executor();
+    asio::dispatch(executor, [session = std::move(session), msg = std::move(msg), executor]() mutable {
+      // moved away before dispatched
+      if (session->get_executor() != executor) {
+        publish_to(std::move(session), std::move(msg));
+        return;
+      }
+      session->rpc->cmd(cmd_publish)->msg(*msg)->retry(-1)->call();
+    });
   }
 
   void remove_rpc(const dds::rpc_s& rpc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rpc_session_map_.erase(rpc);
     std::vector<std::string> empty_topic;
     for (auto& kv : topic_rpc_map_) {
       const auto& topic = kv.first;
@@ -83,6 +123,7 @@ class dds_server_t {
   }
 
   void update_topic_list(const dds::rpc_s& rpc, const std::vector<std::string>& topic_list) {
+    std::lock_guard<std::mutex> lock(mutex_);
     for (auto& topic : topic_list) {
       topic_rpc_map_[topic].insert(rpc);
     }
@@ -90,7 +131,10 @@ class dds_server_t {
 
  private:
   detail::rpc_server_t<T> server_;
+  // sessions may run on io_context_pool threads or strands
+  std::mutex mutex_;
   std::unordered_map<std::string, std::set<dds::rpc_s>> topic_rpc_map_;
+  std::unordered_map<dds::rpc_s, std::weak_ptr<rpc_session_t<T>>> rpc_session_map_;
 };
 
 }  // namespace detail
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "asio.hpp"
+#include "noncopyable.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * resolved endpoints by "host:port", shared by all clients of the process
+ * reconnects after an outage reuse them instead of resolving all at once
+ * threadsafe
+ */
+class dns_cache : private noncopyable {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  static dns_cache& instance() {
+    static dns_cache cache;
+    return cache;
+  }
+
+  static std::string make_key(const std::string& host, uint16_t port) {
+    return host + ":" + std::to_string(port);
+  }
+
+  /**
+   * @param ttl max age of endpoints, decided by reader
+   * @return false if not cached or expired
+   */
+  bool get(const std::string& key, std::chrono::milliseconds ttl, std::vector<asio::ip::tcp::endpoint>& endpoints) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    if (clock::now() - it->second.time >= ttl) {
+      entries_.erase(it);
+      return false;
+    }
+    endpoints = it->second.endpoints;
+    return true;
+  }
+
+  void put(const std::string& key, std::vector<asio::ip::tcp::endpoint> endpoints) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[key] = {std::move(endpoints), clock::now()};
+  }
+
+  /**
+   * e.g. all endpoints failed to connect, resolve again next time
+   */
+  void remove(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(key);
+  }
+
+ private:
+  struct entry {
+    std::vector<asio::ip::tcp::endpoint> endpoints;
+    clock::time_point time;
+  };
+  std::unordered_map<std::string, entry> entries_;
+  std::mutex mutex_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "asio.hpp"
+#include "busy_poll.hpp"
+#include "log.h"
+#include "noncopyable.hpp"
+#include "thread_option.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * N io_contexts, each run by its own thread, optionally pinned to cpu or numa node and in real-time scheduling class
+ * threads can busy poll for latency of sessions, @see set_busy_poll
+ * used by server to spread sessions on multiple cores, @see tcp_server_t::set_io_context_pool
+ * clients can run on it too, e.g. tcp_client(pool.get_io_context(i)) without calling run()
+ * sessions are created on the pool thread, so memory of them is allocated from the local numa node by first touch
+ */
+class io_context_pool : private noncopyable {
+ public:
+  enum class strategy {
+    round_robin,
+    least_loaded,  // fewest alive sessions
+  };
+
+  /**
+   * @param pool_size 0: std::thread::hardware_concurrency()
+   * @param strategy how to assign new session to io_context
+   */
+  explicit io_context_pool(size_t pool_size = 0, strategy strategy = strategy::round_robin) : strategy_(strategy) {
+    if (pool_size == 0) pool_size = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t i = 0; i < pool_size; ++i) {
+      items_.emplace_back(std::make_unique<item>());
+    }
+  }
+
+  ~io_context_pool() {
+    stop();
+  }
+
+ public:
+  /**
+   * start threads, can be called more than once
+   */
+  void start() {
+    if (started_.exchange(true)) return;
+    for (size_t i = 0; i < items_.size(); ++i) {
+      auto& item = items_[i];
+      item->io_context.restart();
+      item->work = std::make_unique<work_guard>(item->io_context.get_executor());
+      item->thread = std::thread([&context = item->io_context, cpus = cpus(i), priority = realtime_priority_, busy_poll = busy_poll_,
+                                  poll_config = busy_poll_config_] {
+        if (!cpus.empty()) set_thread_affinity(cpus);
+        if (priority) set_thread_realtime(priority);
+        if (busy_poll) {
+          run_busy_poll(context, poll_config);
+        } else {
+          context.run();
+        }
+      });
+    }
+  }
+
+  /**
+   * stop all io_contexts and join threads
+   * NOTICE: can not be called on pool thread
+   */
+  void stop() {
+    if (!started_.exchange(false)) return;
+    for (auto& item : items_) {
+      item->work = nullptr;
+      item->io_context.stop();
+    }
+    for (auto& item : items_) {
+      if (item->thread.joinable()) item->thread.join();
+    }
+  }
+
+  /**
+   * pin thread of io_context i to cpus[i % cpus.size()], linux only
+   * also used as SO_INCOMING_CPU hint of reuse_port acceptors
+   * NOTICE: should be called before start
+   */
+  void set_cpu_affinity(const std::vector<int>& cpus) {
+    affinity_.clear();
+    for (int cpu : cpus) {
+      affinity_.push_back({cpu});
+    }
+  }
+
+  /**
+   * pin thread of io_context i to all cpus of numa node nodes[i % nodes.size()], linux only
+   * @param nodes empty: all online nodes with cpu, threads spread on them in turn
+   * NOTICE: should be called before start
+   */
+  void set_numa_affinity(std::vector<int> nodes = {}) {
+    if (nodes.empty()) {
+      for (int node : numa_nodes()) {
+        // memory only node
+        if (!numa_node_cpus(node).empty()) nodes.push_back(node);
+      }
+    }
+    affinity_.clear();
+    for (int node : nodes) {
+      auto cpus = numa_node_cpus(node);
+      if (cpus.empty()) ASIO_NET_LOGW("numa node %d has no cpu", node);
+      affinity_.push_back(std::move(cpus));
+    }
+  }
+
+  /**
+   * run pool threads in real-time scheduling class, @see set_thread_realtime
+   * @param priority 0: disable
+   * NOTICE: should be called before start
+   */
+  void set_realtime_priority(int priority) {
+    realtime_priority_ = priority;
+  }
+
+  /**
+   * run pool threads by run_busy_poll instead of run, cpu of config is ignored, use set_cpu_affinity
+   * NOTICE: should be called before start, each thread burns a cpu while spinning
+   */
+  void set_busy_poll(busy_poll_config config) {
+    config.cpu = -1;
+    busy_poll_ = true;
+    busy_poll_config_ = config;
+  }
+
+  /**
+   * @return cpus which thread of io_context pinned to, empty: not pinned
+   */
+  std::vector<int> cpus(size_t index) const {
+    return affinity_.empty() ? std::vector<int>{} : affinity_[index % affinity_.size()];
+  }
+
+  /**
+   * @return cpu which thread of io_context pinned to, -1: not pinned or pinned to more than one cpu
+   */
+  int cpu(size_t index) const {
+    auto c = cpus(index);
+    return c.size() == 1 ? c[0] : -1;
+  }
+
+  size_t size() const {
+    return items_.size();
+  }
+
+  asio::io_context& get_io_context(size_t index) {
+    return items_[index]->io_context;
+  }
+
+  /**
+   * alive sessions on io_context
+   */
+  uint32_t load(size_t index) const {
+    return *items_[index]->load;
+  }
+
+  /**
+   * select an io_context for new session by strategy
+   */
+  size_t select() {
+    if (strategy_ == strategy::round_robin) {
+      return next_index_++ % items_.size();
+    }
+    size_t index = 0;
+    for (size_t i = 1; i < items_.size(); ++i) {
+      if (*items_[i]->load < *items_[index]->load) index = i;
+    }
+    return index;
+  }
+
+  /**
+   * count a session on io_context, until the returned token released
+   */
+  std::shared_ptr<void> acquire(size_t index) {
+    // token may be released after pool destroyed, e.g. handler of acceptor
+    auto load = items_[index]->load;
+    *load += 1;
+    return {load.get(), [load](void*) {
+              *load -= 1;
+            }};
+  }
+
+ private:
+  using work_guard = asio::executor_work_guard<asio::io_context::executor_type>;
+  struct item {
+    std::shared_ptr<std::atomic<uint32_t>> load = std::make_shared<std::atomic<uint32_t>>(0);
+    asio::io_context io_context{1};
+    std::unique_ptr<work_guard> work;
+    std::thread thread;
+  };
+
+  strategy strategy_;
+  std::atomic_bool started_{false};
+  std::atomic<size_t> next_index_{0};
+  std::vector<std::unique_ptr<item>> items_;
+  std::vector<std::vector<int>> affinity_;
+  int realtime_priority_ = 0;
+  bool busy_poll_ = false;
+  busy_poll_config busy_poll_config_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
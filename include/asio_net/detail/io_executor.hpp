@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+
+#include "asio.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * executor which handlers of a class run on, constructed implicitly from io_context or any executor
+ * e.g. io_context, strand of io_context, asio::thread_pool::executor_type, asio::any_io_executor
+ */
+class io_executor {
+ public:
+  io_executor(asio::io_context& io_context)  // NOLINT(google-explicit-constructor)
+      : executor_(io_context.get_executor()), io_context_(&io_context) {}
+
+  template <typename Executor, typename std::enable_if<asio::execution::is_executor<Executor>::value, int>::type = 0>
+  io_executor(const Executor& executor)  // NOLINT(google-explicit-constructor)
+      : executor_(executor), io_context_(io_context_of(executor_)) {}
+
+ public:
+  const asio::any_io_executor& get() const {
+    return executor_;
+  }
+
+  /**
+   * io_context behind the executor or strand of it, nullptr for other execution context, e.g. asio::thread_pool
+   * blocking operations like run and run_one are only available on io_context
+   */
+  asio::io_context* io_context() const {
+    return io_context_;
+  }
+
+  /**
+   * io_context behind the executor
+   * @throw std::logic_error for other execution context, use the executor instead
+   */
+  asio::io_context& get_io_context() const {
+    if (!io_context_) throw std::logic_error("get_io_context: not running on io_context, use get_executor");
+    return *io_context_;
+  }
+
+  /**
+   * handlers may run concurrently on many threads, e.g. asio::thread_pool or strand of it
+   * io_context passed directly or by its executor is treated as single thread, as before
+   */
+  bool is_concurrent() const {
+    return !target<asio::io_context::executor_type>(executor_);
+  }
+
+  /**
+   * executor whose handlers never run concurrently: itself if not concurrent, otherwise a new strand on it
+   */
+  io_executor make_strand() const {
+    if (!is_concurrent()) return *this;
+    return io_executor(asio::make_strand(executor_));
+  }
+
+ private:
+  /**
+   * type checked, any_executor::target of old asio does not check type
+   */
+  template <typename Executor>
+  static const Executor* target(const asio::any_io_executor& executor) {
+    return executor.target_type() == typeid(Executor) ? executor.target<Executor>() : nullptr;
+  }
+
+  static asio::io_context* io_context_of(const asio::any_io_executor& executor) {
+    if (auto ex = target<asio::io_context::executor_type>(executor)) return &ex->context();
+    if (auto strand = target<asio::strand<asio::io_context::executor_type>>(executor)) return &strand->get_inner_executor().context();
+    if (auto strand = target<asio::strand<asio::any_io_executor>>(executor)) return io_context_of(strand->get_inner_executor());
+    return nullptr;
+  }
+
+ private:
+  asio::any_io_executor executor_;
+  asio::io_context* io_context_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
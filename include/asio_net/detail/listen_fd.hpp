@@ -0,0 +1,130 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+#include "log.h"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * pre-opened listening socket, e.g. systemd socket activation, inherited or received from old process
+ * server takes the ownership
+ */
+struct listen_fd {
+  int fd = -1;
+};
+
+inline void set_cloexec(int fd) {
+  int flags = ::fcntl(fd, F_GETFD);
+  if (flags < 0 || ::fcntl(fd, F_SETFD, flags | FD_CLOEXEC) != 0) {
+    ASIO_NET_LOGW("set_cloexec: %d, %s", fd, std::strerror(errno));
+  }
+}
+
+/**
+ * listening sockets passed by systemd socket activation, start from fd 3
+ * fds are marked close-on-exec, and the environment is removed by default, so children not adopt them again
+ * @see sd_listen_fds(3)
+ */
+inline std::vector<listen_fd> systemd_listen_fds(bool unset_environment = true) {
+  std::vector<listen_fd> fds;
+  const char* pid = std::getenv("LISTEN_PID");
+  const char* num = std::getenv("LISTEN_FDS");
+  // passed to this process, not inherited from parent
+  bool valid = pid && num && std::strtol(pid, nullptr, 10) == (long)::getpid();
+  long n = valid ? std::strtol(num, nullptr, 10) : 0;
+  if (unset_environment) {
+    ::unsetenv("LISTEN_PID");
+    ::unsetenv("LISTEN_FDS");
+    ::unsetenv("LISTEN_FDNAMES");
+  }
+  for (long i = 0; i < n; ++i) {
+    int fd = 3 + (int)i;
+    set_cloexec(fd);
+    fds.push_back({fd});
+  }
+  return fds;
+}
+
+/**
+ * send listening socket to new process over domain socket, by SCM_RIGHTS
+ * the fd is duplicated into peer, and still owned by this process
+ */
+inline bool send_listen_fd(asio::local::stream_protocol::socket& socket, int fd) {
+  char data = 'F';
+  iovec iov{&data, 1};
+  char control[CMSG_SPACE(sizeof(int))]{};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  asio::error_code ec;
+  socket.wait(asio::socket_base::wait_write, ec);
+  if (ec || ::sendmsg(socket.native_handle(), &msg, 0) != 1) {
+    ASIO_NET_LOGE("send_listen_fd: %s", ec ? ec.message().c_str() : std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * receive listening socket from old process, block until received
+ * @return fd < 0 if failed
+ */
+inline listen_fd recv_listen_fd(asio::local::stream_protocol::socket& socket) {
+  char data;
+  iovec iov{&data, 1};
+  char control[CMSG_SPACE(sizeof(int))]{};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+#ifdef MSG_CMSG_CLOEXEC
+  const int flags = MSG_CMSG_CLOEXEC;
+#else
+  const int flags = 0;
+#endif
+  asio::error_code ec;
+  socket.wait(asio::socket_base::wait_read, ec);
+  if (ec || ::recvmsg(socket.native_handle(), &msg, flags) != 1) {
+    ASIO_NET_LOGE("recv_listen_fd: %s", ec ? ec.message().c_str() : std::strerror(errno));
+    return {};
+  }
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+    ASIO_NET_LOGE("recv_listen_fd: no fd received");
+    return {};
+  }
+  listen_fd fd;
+  std::memcpy(&fd.fd, CMSG_DATA(cmsg), sizeof(int));
+#ifndef MSG_CMSG_CLOEXEC
+  set_cloexec(fd.fd);
+#endif
+  return fd;
+}
+
+}  // namespace detail
+}  // namespace asio_net
+
+#endif
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "asio.hpp"
+#include "io_executor.hpp"
+#include "log.h"
+#include "noncopyable.hpp"
+
+namespace asio_net {
+
+/**
+ * histogram of event loop lag, bucket i counts lag in [2^(i-1), 2^i) us, bucket 0 counts lag < 1us
+ */
+struct loop_lag_stats {
+  uint64_t count = 0;
+  uint64_t sum_us = 0;
+  uint64_t max_us = 0;
+  std::array<uint64_t, 32> buckets{};
+
+  /**
+   * @param p in [0, 1], e.g. 0.99
+   * @return upper bound of the bucket, us
+   */
+  uint64_t percentile(double p) const {
+    if (count == 0) return 0;
+    auto rank = std::max<uint64_t>(1, (uint64_t)std::ceil((double)count * p));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen >= rank) return std::min<uint64_t>(uint64_t(1) << i, max_us);
+    }
+    return max_us;
+  }
+};
+
+namespace detail {
+
+/**
+ * measure dispatch delay of io_context: a timer probe armed periodically, lag is the time from its expiry to its handler running
+ * long handlers on the io_context, e.g. heavy on_data, show up as lag of all sessions on it
+ * NOTICE: start/stop/destroy on the thread running io_context, or after it stopped
+ */
+class loop_monitor : private noncopyable {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  /**
+   * @param executor io_context, or any executor e.g. strand of a thread pool
+   * @param interval between probes
+   * @param threshold @see on_lag fired when lag >= threshold
+   */
+  explicit loop_monitor(const io_executor& executor, std::chrono::milliseconds interval = std::chrono::milliseconds(100),
+                        std::chrono::milliseconds threshold = std::chrono::milliseconds(50))
+      : interval_(interval), threshold_(threshold), timer_(executor.get()) {}
+
+ public:
+  void start() {
+    if (running_) return;
+    running_ = true;
+    do_probe(++generation_);
+  }
+
+  void stop() {
+    running_ = false;
+    ++generation_;
+    expiry_ns_ = 0;
+    timer_.cancel();
+  }
+
+  /**
+   * threadsafe
+   */
+  loop_lag_stats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  /**
+   * threadsafe
+   */
+  void reset_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = {};
+  }
+
+  /**
+   * lag of the probe expired but not run yet, zero if none
+   * threadsafe, e.g. checked by a watchdog thread when io_context is blocked and probe can not run
+   */
+  std::chrono::microseconds pending_lag() const {
+    auto expiry = expiry_ns_.load();
+    if (expiry == 0) return std::chrono::microseconds::zero();
+    auto lag = clock::now().time_since_epoch() - std::chrono::nanoseconds(expiry);
+    return std::max(std::chrono::duration_cast<std::chrono::microseconds>(lag), std::chrono::microseconds::zero());
+  }
+
+ private:
+  /**
+   * @param generation probes of previous start are dropped
+   */
+  void do_probe(uint32_t generation) {
+    auto expiry = clock::now() + interval_;
+    expiry_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(expiry.time_since_epoch()).count();
+    timer_.expires_at(expiry);
+    timer_.async_wait([this, generation, expiry, alive = std::weak_ptr<void>(is_alive_)](const std::error_code& ec) {
+      if (alive.expired() || ec || generation != generation_) return;
+      expiry_ns_ = 0;
+      on_probe(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - expiry));
+      if (generation == generation_) do_probe(generation);
+    });
+  }
+
+  void on_probe(std::chrono::microseconds lag) {
+    auto us = (uint64_t)std::max<int64_t>(lag.count(), 0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.count += 1;
+      stats_.sum_us += us;
+      stats_.max_us = std::max(stats_.max_us, us);
+      size_t bucket = 0;
+      while (bucket + 1 < stats_.buckets.size() && (uint64_t(1) << bucket) <= us) ++bucket;
+      stats_.buckets[bucket] += 1;
+    }
+    if (lag >= threshold_) {
+      ASIO_NET_LOGW("event loop lag: %lluus", (unsigned long long)us);
+      if (on_lag) on_lag(lag);
+    }
+  }
+
+ public:
+  std::function<void(std::chrono::microseconds)> on_lag;
+
+ private:
+  const std::chrono::milliseconds interval_;
+  const std::chrono::milliseconds threshold_;
+  asio::steady_timer timer_;
+  bool running_ = false;
+  uint32_t generation_ = 0;
+  std::atomic<int64_t> expiry_ns_{0};
+  loop_lag_stats stats_;
+  mutable std::mutex mutex_;
+  std::shared_ptr<void> is_alive_ = std::make_shared<uint8_t>();
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <utility>
+
+#include "client_pool_t.hpp"
+#include "rpc_client_t.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * rpc_client_t connections to the same server, calls are spread over them by picking an rpc
+ */
+template <socket_type T>
+class rpc_client_pool_t : public client_pool_t<T, rpc_client_t<T>> {
+ public:
+  /**
+   * @param executor io_context or any executor, connections share one strand if it is concurrent
+   */
+  explicit rpc_client_pool_t(io_executor executor, client_pool_config pool_config = {}, rpc_config rpc_config = {})
+      : client_pool_t<T, rpc_client_t<T>>(std::move(executor), pool_config) {
+    for (uint32_t i = 0; i < std::max(pool_config.pool_size, 1u); ++i) {
+      this->clients_.emplace_back(std::make_unique<rpc_client_t<T>>(this->executor_, rpc_config));
+    }
+    init();
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  explicit rpc_client_pool_t(io_executor executor, asio::ssl::context& ssl_context, client_pool_config pool_config = {}, rpc_config rpc_config = {})
+      : client_pool_t<T, rpc_client_t<T>>(std::move(executor), pool_config) {
+    for (uint32_t i = 0; i < std::max(pool_config.pool_size, 1u); ++i) {
+      this->clients_.emplace_back(std::make_unique<rpc_client_t<T>>(this->executor_, ssl_context, rpc_config));
+    }
+    init();
+  }
+#endif
+
+  /**
+   * rpc of the least loaded connection, e.g. pool.rpc()->cmd("cmd")->call()
+   * @return nullptr if no connection open
+   */
+  std::shared_ptr<rpc_core::rpc> rpc() {
+    auto index = this->select();
+    return index == this->npos ? nullptr : rpcs_[index];
+  }
+
+  /**
+   * rpc of the connection pinned to key, calls of the same key are sent in order
+   * @return nullptr if no connection open
+   */
+  std::shared_ptr<rpc_core::rpc> rpc_by_key(size_t key) {
+    auto index = this->select(key);
+    return index == this->npos ? nullptr : rpcs_[index];
+  }
+
+ private:
+  void init() {
+    rpcs_.resize(this->clients_.size());
+    for (size_t i = 0; i < this->clients_.size(); ++i) {
+      auto& client = this->clients_[i];
+      client->on_open = [this, i](std::shared_ptr<rpc_core::rpc> rpc) {
+        rpcs_[i] = rpc;
+        if (on_rpc_open) on_rpc_open(std::move(rpc));
+        this->set_open(i, true);
+      };
+      client->on_open_failed = [this](std::error_code ec) {
+        if (this->on_open_failed) this->on_open_failed(ec);
+      };
+      client->on_close = [this, i] {
+        rpcs_[i] = nullptr;
+        this->set_open(i, false);
+      };
+    }
+  }
+
+ public:
+  // every connection opened or reopened, e.g. subscribe cmds called by server
+  std::function<void(std::shared_ptr<rpc_core::rpc>)> on_rpc_open;
+
+ private:
+  std::vector<std::shared_ptr<rpc_core::rpc>> rpcs_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
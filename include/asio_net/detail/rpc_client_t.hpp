@@ -13,16 +13,14 @@ namespace detail {
 template <socket_type T>
 class rpc_client_t : noncopyable {
  public:
-  explicit rpc_client_t(asio::io_context& io_context, rpc_config rpc_config = {})
-      : io_context_(io_context), rpc_config_(rpc_config), client_(std::make_shared<detail::tcp_client_t<T>>(io_context, rpc_config.to_tcp_config())) {
+  explicit rpc_client_t(io_executor executor, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), client_(std::make_shared<detail::tcp_client_t<T>>(std::move(executor), rpc_config.to_tcp_config())) {
     init();
   }
 
 #ifdef ASIO_NET_ENABLE_SSL
-  explicit rpc_client_t(asio::io_context& io_context, asio::ssl::context& ssl_context, rpc_config rpc_config = {})
-      : io_context_(io_context),
-        rpc_config_(rpc_config),
-        client_(std::make_shared<detail::tcp_client_t<T>>(io_context, ssl_context, rpc_config.to_tcp_config())) {
+  explicit rpc_client_t(io_executor executor, asio::ssl::context& ssl_context, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), client_(std::make_shared<detail::tcp_client_t<T>>(std::move(executor), ssl_context, rpc_config.to_tcp_config())) {
     init();
   }
 #endif
@@ -53,10 +51,24 @@ class rpc_client_t : noncopyable {
     return rpc_config_;
   }
 
+  /**
+   * @see tcp_channel_t::send_buffer_size
+   */
+  size_t send_buffer_size() const {
+    return client_->send_buffer_size();
+  }
+
   void run() {
     client_->run();
   }
 
+  /**
+   * @see tcp_client_t::run_busy_poll
+   */
+  void run_busy_poll(busy_poll_config config = {}) {
+    client_->run_busy_poll(config);
+  }
+
   void stop() {
     client_->stop();
   }
@@ -64,7 +76,7 @@ class rpc_client_t : noncopyable {
  private:
   void init() {
     client_->on_open = [this]() {
-      auto session = std::make_shared<rpc_session_t<T>>(io_context_, rpc_config_);
+      auto session = std::make_shared<rpc_session_t<T>>(client_->get_executor(), rpc_config_);
       rpc_session_ = session;
       session->init(client_);
 
@@ -88,7 +100,6 @@ class rpc_client_t : noncopyable {
   std::function<void(std::error_code)> on_open_failed;
 
  private:
-  asio::io_context& io_context_;
   rpc_config rpc_config_;
   std::shared_ptr<detail::tcp_client_t<T>> client_;
   std::weak_ptr<rpc_session_t<T>> rpc_session_;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <utility>
 
 #include "asio.hpp"
@@ -12,35 +13,88 @@ namespace detail {
 template <socket_type T>
 class rpc_server_t : noncopyable {
  public:
-  rpc_server_t(asio::io_context& io_context, uint16_t port, rpc_config rpc_config = {})
-      : io_context_(io_context), rpc_config_(rpc_config), server_(io_context, port, rpc_config.to_tcp_config()) {
+  rpc_server_t(io_executor executor, uint16_t port, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), server_(std::move(executor), port, rpc_config.to_tcp_config()) {
     static_assert(T == detail::socket_type::normal, "");
     init();
   }
 
 #ifdef ASIO_NET_ENABLE_SSL
-  rpc_server_t(asio::io_context& io_context, uint16_t port, asio::ssl::context& ssl_context, rpc_config rpc_config = {})
-      : io_context_(io_context), rpc_config_(rpc_config), server_(io_context, port, ssl_context, rpc_config.to_tcp_config()) {
+  rpc_server_t(io_executor executor, uint16_t port, asio::ssl::context& ssl_context, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), server_(std::move(executor), port, ssl_context, rpc_config.to_tcp_config()) {
     static_assert(T == detail::socket_type::ssl, "");
     init();
   }
 #endif
 
-  rpc_server_t(asio::io_context& io_context, const std::string& endpoint, rpc_config rpc_config = {})
-      : io_context_(io_context), rpc_config_(rpc_config), server_(io_context, endpoint, rpc_config.to_tcp_config()) {
+  rpc_server_t(io_executor executor, const std::string& endpoint, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), server_(std::move(executor), endpoint, rpc_config.to_tcp_config()) {
     static_assert(T == detail::socket_type::domain, "");
     init();
   }
 
+#ifndef _WIN32
+  rpc_server_t(io_executor executor, listen_fd fd, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), server_(std::move(executor), fd, rpc_config.to_tcp_config()) {
+    init();
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  rpc_server_t(io_executor executor, listen_fd fd, asio::ssl::context& ssl_context, rpc_config rpc_config = {})
+      : rpc_config_(rpc_config), server_(std::move(executor), fd, ssl_context, rpc_config.to_tcp_config()) {
+    init();
+  }
+#endif
+#endif
+
  public:
   void start(bool loop = false) {
     server_.start(loop);
   }
 
+  /**
+   * @see tcp_server_t::set_io_context_pool
+   * NOTICE: rpc_config.rpc(single connection) is not supported
+   */
+  void set_io_context_pool(std::shared_ptr<io_context_pool> pool) {
+    server_.set_io_context_pool(std::move(pool));
+  }
+
+  /**
+   * move session to io_context of pool, rpc timeouts and ping follow it
+   * @see tcp_server_t::migrate
+   */
+  void migrate(const std::shared_ptr<rpc_session_t<T>>& session, size_t index, std::function<void(bool)> handle = nullptr) {
+    auto tcp_session = session->tcp_session_.lock();
+    if (!tcp_session) {
+      if (handle) handle(false);
+      return;
+    }
+    server_.migrate(std::static_pointer_cast<tcp_session_t<T>>(tcp_session), index, std::move(handle));
+  }
+
+  /**
+   * @see tcp_server_t::native_handle
+   */
+  auto native_handle() {
+    return server_.native_handle();
+  }
+
+  /**
+   * @see tcp_server_t::drain
+   */
+  void drain(std::chrono::milliseconds timeout) {
+    server_.drain(timeout);
+  }
+
  private:
   void init() {
+    if (rpc_config_.session_pool_size) session_pools_ = std::make_shared<block_pool_map>(rpc_config_.session_pool_size);
     server_.on_session = [this](std::weak_ptr<detail::tcp_session_t<T>> ws) {
-      auto session = std::make_shared<rpc_session_t<T>>(io_context_, rpc_config_);
+      // run on executor of tcp_session, may be one of io_context_pool or a strand
+      auto executor = ws.lock()->get_executor();
+      auto pool = session_pools_ ? session_pools_->get(&executor.context()) : nullptr;
+      auto session = make_shared_pooled<rpc_session_t<T>>(pool, std::move(executor), rpc_config_);
       if (!session->init(std::move(ws))) return;
       if (on_session) {
         on_session(session);
@@ -61,9 +115,9 @@ class rpc_server_t : noncopyable {
 #endif
 
  private:
-  asio::io_context& io_context_;
   rpc_config rpc_config_;
   detail::tcp_server_t<T> server_;
+  std::shared_ptr<block_pool_map> session_pools_;
 };
 
 }  // namespace detail
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <mutex>
 #include <utility>
 
 #include "noncopyable.hpp"
@@ -10,10 +11,17 @@
 namespace asio_net {
 namespace detail {
 
+template <socket_type T>
+class rpc_server_t;
+
 template <socket_type T>
 class rpc_session_t : noncopyable, public std::enable_shared_from_this<rpc_session_t<T>> {
  public:
-  explicit rpc_session_t(asio::io_context& io_context, rpc_config& rpc_config) : io_context_(io_context), rpc_config_(rpc_config) {
+  /**
+   * @param executor of the tcp_session, @see tcp_channel_t::get_executor
+   * @param rpc_config
+   */
+  explicit rpc_session_t(asio::any_io_executor executor, rpc_config& rpc_config) : executor_(std::move(executor)), rpc_config_(rpc_config) {
     ASIO_NET_LOGD("rpc_session: %p", this);
   }
 
@@ -37,11 +45,20 @@ class rpc_session_t : noncopyable, public std::enable_shared_from_this<rpc_sessi
       rpc = rpc_core::rpc::create();
     }
 
-    rpc->set_timer([this](uint32_t ms, rpc_core::rpc::timeout_cb cb) {
-      auto timer = std::make_shared<asio::steady_timer>(io_context_);
+    rpc->set_timer([this, ws = std::weak_ptr<rpc_session_t>(this->shared_from_this())](uint32_t ms, rpc_core::rpc::timeout_cb cb) {
+      auto timer = std::make_shared<asio::steady_timer>(get_executor());
       timer->expires_after(std::chrono::milliseconds(ms));
       auto tp = timer.get();
-      tp->async_wait([timer = std::move(timer), cb = std::move(cb)](const std::error_code&) {
+      tp->async_wait([timer = std::move(timer), cb = std::move(cb), ws](const std::error_code&) {
+        // session may be migrated after timer armed, rpc is only used on current executor
+        auto session = ws.lock();
+        if (session) {
+          auto executor = session->get_executor();
+          if (executor != timer->get_executor()) {
+            asio::dispatch(std::move(executor), std::move(cb));
+            return;
+          }
+        }
         cb();
       });
     });
@@ -58,29 +75,30 @@ class rpc_session_t : noncopyable, public std::enable_shared_from_this<rpc_sessi
     rpc->set_ready(true);
 
     // save origin on_close(may from tcp_client)
-    auto oc = tcp_session->on_close;
+    auto oc = std::move(tcp_session->on_close);
     // bind rpc_session lifecycle to tcp_session and end with on_close
-    tcp_session->on_close = [this, rpc_session = this->shared_from_this(), oc = std::move(oc)]() mutable {
-      if (oc) oc();
-
-      rpc->set_ready(false);
-
-      stop_ping();
-
-      if (rpc_session->on_close) {
-        rpc_session->on_close();
-      }
-      // post delay destroy rpc_session, ensure rpc.rsp() callback finish
-      asio::post(io_context_, [rpc_session = std::move(rpc_session)] {});
-      // clear tcp_session->on_close, avoid called more than once by close api
-      tcp_session_.lock()->on_close = nullptr;
-    };
+    // capture only the shared_ptr on server, small enough to be stored in std::function without allocation
+    if (oc) {
+      tcp_session->on_close = [rpc_session = this->shared_from_this(), oc = std::move(oc)]() mutable {
+        oc();
+        rpc_session_t::on_tcp_close(std::move(rpc_session));
+      };
+    } else {
+      tcp_session->on_close = [rpc_session = this->shared_from_this()]() mutable {
+        rpc_session_t::on_tcp_close(std::move(rpc_session));
+      };
+    }
 
     assert(tcp_session->on_data == nullptr);  // ensure it's empty
     tcp_session->on_data = [this](std::string data) {
       rpc->get_connection()->on_recv_package(std::move(data));
     };
 
+    tcp_session->set_migrate_hook([ws = std::weak_ptr<rpc_session_t>(this->shared_from_this())] {
+      auto session = ws.lock();
+      if (session) session->on_migrate();
+    });
+
     start_ping();
     return true;
   }
@@ -92,10 +110,27 @@ class rpc_session_t : noncopyable, public std::enable_shared_from_this<rpc_sessi
     }
   }
 
+  /**
+   * executor which session handlers run on
+   * threadsafe, changed on migrate
+   */
+  asio::any_io_executor get_executor() const {
+    std::lock_guard<std::mutex> lock(executor_mutex_);
+    return executor_;
+  }
+
+  /**
+   * io_context which session handlers run on
+   * @throw std::logic_error if not running on io_context, e.g. asio::thread_pool, @see get_executor
+   */
+  asio::io_context& get_io_context() const {
+    return io_executor(get_executor()).get_io_context();
+  }
+
   void start_ping() {
     if (rpc_config_.ping_interval_ms == 0) return;
     if (!ping_timer_) {
-      ping_timer_ = std::make_unique<asio::steady_timer>(io_context_);
+      ping_timer_ = std::make_unique<asio::steady_timer>(get_executor());
     }
     ping_timer_->expires_after(std::chrono::milliseconds(rpc_config_.ping_interval_ms));
     ping_timer_->async_wait([ws = std::weak_ptr<rpc_session_t<T>>(rpc_session_t<T>::shared_from_this())](std::error_code ec) {
@@ -131,6 +166,43 @@ class rpc_session_t : noncopyable, public std::enable_shared_from_this<rpc_sessi
     }
   }
 
+ private:
+  /**
+   * called on old executor after tcp_session migrated, @see tcp_channel_t::migrate
+   */
+  void on_migrate() {
+    auto executor = tcp_session_.lock()->get_executor();
+    {
+      // timer handlers armed before an earlier migrate may read it on their own thread
+      std::lock_guard<std::mutex> lock(executor_mutex_);
+      executor_ = executor;
+    }
+    if (ping_timer_) {
+      stop_ping();
+      asio::post(executor, [ws = std::weak_ptr<rpc_session_t>(this->shared_from_this())] {
+        auto session = ws.lock();
+        if (session) session->start_ping();
+      });
+    }
+  }
+
+  static void on_tcp_close(std::shared_ptr<rpc_session_t> rpc_session) {
+    rpc_session->rpc->set_ready(false);
+
+    rpc_session->stop_ping();
+
+    if (rpc_session->on_close) {
+      rpc_session->on_close();
+    }
+    auto executor = rpc_session->get_executor();
+    auto tcp_session = rpc_session->tcp_session_.lock();
+    // post delay destroy rpc_session, ensure rpc.rsp() callback finish
+    asio::post(executor, [rpc_session = std::move(rpc_session)] {});
+    // clear tcp_session->on_close, avoid called more than once by close api
+    // NOTICE: this destroys the running lambda, nothing captured should be used after
+    if (tcp_session) tcp_session->on_close = nullptr;
+  }
+
  public:
   std::function<void()> on_close;
 
@@ -138,7 +210,9 @@ class rpc_session_t : noncopyable, public std::enable_shared_from_this<rpc_sessi
   std::shared_ptr<rpc_core::rpc> rpc;
 
  private:
-  asio::io_context& io_context_;
+  friend class rpc_server_t<T>;
+  mutable std::mutex executor_mutex_;
+  asio::any_io_executor executor_;  // guarded by executor_mutex_
   rpc_config& rpc_config_;
   std::weak_ptr<detail::tcp_channel_t<T>> tcp_session_;
   std::unique_ptr<asio::steady_timer> ping_timer_;
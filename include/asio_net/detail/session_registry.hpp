@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "noncopyable.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * alive sessions of server, threadsafe
+ * session should call remove when destroyed
+ */
+template <typename Session>
+class session_registry : private noncopyable {
+ public:
+  /**
+   * @param established false: counted by size but not in snapshot until @see`establish`, e.g. ssl session in handshake
+   */
+  void add(const std::shared_ptr<Session>& session, bool established = true) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    (established ? sessions_ : pending_).emplace(session.get(), session);
+  }
+
+  void establish(Session* key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(key);
+    if (it == pending_.end()) return;
+    sessions_.emplace(key, std::move(it->second));
+    pending_.erase(it);
+  }
+
+  void remove(Session* key) {
+    std::vector<std::function<void()>> paused;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (sessions_.erase(key) == 0) pending_.erase(key);
+      paused.swap(paused_);
+    }
+    for (auto& resume : paused) {
+      resume();
+    }
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size() + pending_.size();
+  }
+
+  std::vector<std::shared_ptr<Session>> snapshot() const {
+    std::vector<std::shared_ptr<Session>> sessions;
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions.reserve(sessions_.size());
+    for (const auto& kv : sessions_) {
+      auto session = kv.second.lock();
+      if (session) sessions.push_back(std::move(session));
+    }
+    return sessions;
+  }
+
+  /**
+   * @param resume called once after a session removed, if paused
+   * @return true if sessions >= limit and paused
+   */
+  bool pause_if_full(size_t limit, std::function<void()> resume) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.size() + pending_.size() < limit) return false;
+    paused_.push_back(std::move(resume));
+    return true;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<Session*, std::weak_ptr<Session>> sessions_;
+  std::unordered_map<Session*, std::weak_ptr<Session>> pending_;  // not established
+  std::vector<std::function<void()>> paused_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
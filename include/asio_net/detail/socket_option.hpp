@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cerrno>
+#include <string>
+
+#include "../config.hpp"
+#include "asio.hpp"
+#include "log.h"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * set raw socket option, failure will be logged and ignored
+ */
+template <typename Socket>
+inline bool set_socket_option(Socket& socket, int level, int name, const void* value, size_t size, const char* desc) {
+  if (::setsockopt(socket.native_handle(), level, name, (const char*)value, (int)size) != 0) {
+#ifdef _WIN32
+    int err = WSAGetLastError();
+#else
+    int err = errno;
+#endif
+    ASIO_NET_LOGW("set socket option %s failed: %s", desc, asio::error_code(err, asio::error::get_system_category()).message().c_str());
+    return false;
+  }
+  return true;
+}
+
+template <typename Socket>
+inline bool set_socket_option(Socket& socket, int level, int name, uint32_t value, const char* desc) {
+  if (value == UINT32_MAX) return true;
+  int v = (int)value;
+  return set_socket_option(socket, level, name, &v, sizeof(v), desc);
+}
+
+/**
+ * not tcp socket, e.g. domain socket
+ */
+template <typename Socket>
+inline void apply_tcp_options(Socket& /*socket*/, const tcp_config& /*config*/) {}
+
+/**
+ * apply tcp tuning options of tcp_config
+ */
+template <typename Executor>
+inline void apply_tcp_options(asio::basic_socket<asio::ip::tcp, Executor>& socket, const tcp_config& config) {
+  set_socket_option(socket, IPPROTO_TCP, TCP_NODELAY, config.socket_nodelay, "TCP_NODELAY");
+  set_socket_option(socket, SOL_SOCKET, SO_KEEPALIVE, config.socket_keepalive, "SO_KEEPALIVE");
+
+  asio::error_code ec;
+  auto endpoint = socket.local_endpoint(ec);
+  if (!ec && endpoint.address().is_v6()) {
+#ifdef IPV6_TCLASS
+    set_socket_option(socket, IPPROTO_IPV6, IPV6_TCLASS, config.socket_tos, "IPV6_TCLASS");
+#endif
+  } else {
+    set_socket_option(socket, IPPROTO_IP, IP_TOS, config.socket_tos, "IP_TOS");
+  }
+
+#if defined(TCP_KEEPIDLE)
+  set_socket_option(socket, IPPROTO_TCP, TCP_KEEPIDLE, config.socket_keepalive_idle_s, "TCP_KEEPIDLE");
+#elif defined(TCP_KEEPALIVE)
+  set_socket_option(socket, IPPROTO_TCP, TCP_KEEPALIVE, config.socket_keepalive_idle_s, "TCP_KEEPALIVE");
+#endif
+#ifdef TCP_KEEPINTVL
+  set_socket_option(socket, IPPROTO_TCP, TCP_KEEPINTVL, config.socket_keepalive_interval_s, "TCP_KEEPINTVL");
+#endif
+#ifdef TCP_KEEPCNT
+  set_socket_option(socket, IPPROTO_TCP, TCP_KEEPCNT, config.socket_keepalive_count, "TCP_KEEPCNT");
+#endif
+#ifdef TCP_NOTSENT_LOWAT
+  set_socket_option(socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT, config.socket_notsent_lowat, "TCP_NOTSENT_LOWAT");
+#endif
+
+#ifdef __linux__
+  // NOTICE: TCP_QUICKACK is not permanent, kernel may turn it off later
+  set_socket_option(socket, IPPROTO_TCP, TCP_QUICKACK, config.socket_quickack, "TCP_QUICKACK");
+#ifdef SO_BUSY_POLL
+  set_socket_option(socket, SOL_SOCKET, SO_BUSY_POLL, config.socket_busy_poll_us, "SO_BUSY_POLL");
+#endif
+  set_socket_option(socket, SOL_SOCKET, SO_PRIORITY, config.socket_priority, "SO_PRIORITY");
+  if (!config.socket_congestion.empty()) {
+    set_socket_option(socket, IPPROTO_TCP, TCP_CONGESTION, config.socket_congestion.data(), config.socket_congestion.size(), "TCP_CONGESTION");
+  }
+#endif
+}
+
+/**
+ * client options which must be set before connect
+ */
+template <typename Executor>
+inline void apply_connect_options(asio::basic_socket<asio::ip::tcp, Executor>& socket, const tcp_config& config) {
+  if (!config.socket_fastopen_connect) return;
+#ifdef TCP_FASTOPEN_CONNECT
+  set_socket_option(socket, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, 1u, "TCP_FASTOPEN_CONNECT");
+#else
+  (void)socket;
+  ASIO_NET_LOGW("TCP_FASTOPEN_CONNECT: not supported");
+#endif
+}
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../config.hpp"
+#include "log.h"
+#include "noncopyable.hpp"
+#include "tcp_channel_t.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * one logical channel over multiple tcp connections(stripes)
+ * messages are split into sequenced chunks, sent round-robin on stripes, and reassembled in order by peer
+ *
+ * frames on each stripe(auto_pack):
+ * hello: [type:u8=0][group_id:u64][stripe_num:u32][index:u32], first frame from client
+ * chunk: [type:u8=1][seq:u64][flags:u8][payload], flags & 1: last chunk of message
+ */
+template <socket_type T>
+class striped_channel_t : private noncopyable {
+ public:
+  enum frame_type : uint8_t {
+    frame_hello = 0,
+    frame_chunk = 1,
+  };
+  static constexpr size_t hello_size = 1 + 8 + 4 + 4;
+  static constexpr size_t chunk_header_size = 1 + 8 + 1;
+
+  /**
+   * @param stripe_num may differ from config.stripe_num on server, which is the max
+   */
+  striped_channel_t(uint32_t stripe_num, const striped_config& config)
+      : stripes_(std::max(stripe_num, 1u)),
+        chunk_size_(std::max(config.chunk_size, 1u)),
+        config_(config),
+        recv_window_(stripes_.size() * std::max(config.recv_window, 2u)),
+        stripe_recv_(stripes_.size()) {
+    ASIO_NET_LOGD("striped_channel: %p", this);
+  }
+
+  ~striped_channel_t() {
+    ASIO_NET_LOGD("~striped_channel: %p", this);
+  }
+
+ public:
+  /**
+   * async send message, split into chunks and sent on all stripes
+   * not threadsafe, only can be used on io_context thread
+   *
+   * @param msg can be string or binary
+   */
+  void send(const std::string& msg) {
+    if (!ready_ || closed_) {
+      ASIO_NET_LOGE("send: striped channel not open");
+      return;
+    }
+    size_t offset = 0;
+    do {
+      size_t size = std::min<size_t>(chunk_size_, msg.size() - offset);
+      bool last = offset + size == msg.size();
+      std::string frame;
+      frame.resize(chunk_header_size + size);
+      frame[0] = (char)frame_chunk;
+      std::memcpy(&frame[1], &send_seq_, sizeof(send_seq_));
+      frame[9] = (char)(last ? 1 : 0);
+      if (size) std::memcpy(&frame[chunk_header_size], msg.data() + offset, size);
+      send_seq_ += 1;
+      offset += size;
+
+      auto stripe = stripes_[send_index_].lock();
+      send_index_ = (send_index_ + 1) % stripes_.size();
+      if (!stripe) {
+        close();
+        return;
+      }
+      stripe->send(std::move(frame));
+    } while (offset < msg.size());
+  }
+
+  /**
+   * close all stripes
+   * will trigger @see`on_close` once if opened
+   */
+  void close() {
+    if (closed_) return;
+    closed_ = true;
+    for (auto& ws : stripes_) {
+      auto stripe = ws.lock();
+      if (stripe) stripe->close();
+    }
+    recv_chunks_.clear();
+    recv_chunks_bytes_ = 0;
+    recv_msg_.clear();
+    if (ready_ && on_close) on_close();
+  }
+
+  bool is_open() const {
+    return ready_ && !closed_;
+  }
+
+  uint32_t stripe_num() const {
+    return (uint32_t)stripes_.size();
+  }
+
+ public:
+  static std::string make_hello(uint64_t group_id, uint32_t stripe_num, uint32_t index) {
+    std::string frame;
+    frame.resize(hello_size);
+    frame[0] = (char)frame_hello;
+    std::memcpy(&frame[1], &group_id, sizeof(group_id));
+    std::memcpy(&frame[9], &stripe_num, sizeof(stripe_num));
+    std::memcpy(&frame[13], &index, sizeof(index));
+    return frame;
+  }
+
+  static bool parse_hello(const std::string& frame, uint64_t& group_id, uint32_t& stripe_num, uint32_t& index) {
+    if (frame.size() != hello_size || (uint8_t)frame[0] != frame_hello) return false;
+    std::memcpy(&group_id, &frame[1], sizeof(group_id));
+    std::memcpy(&stripe_num, &frame[9], sizeof(stripe_num));
+    std::memcpy(&index, &frame[13], sizeof(index));
+    return index < stripe_num;
+  }
+
+  /**
+   * @return false if index already used
+   */
+  bool set_stripe(uint32_t index, std::weak_ptr<tcp_channel_t<T>> ws) {
+    if (index >= stripes_.size() || !stripes_[index].expired()) return false;
+    stripes_[index] = std::move(ws);
+    joined_num_ += 1;
+    return true;
+  }
+
+  bool is_complete() const {
+    return joined_num_ == stripes_.size();
+  }
+
+  /**
+   * all stripes joined, start deliver data
+   */
+  void set_ready() {
+    ready_ = true;
+    deliver();
+  }
+
+  /**
+   * @param index stripe the frame received from
+   */
+  void on_stripe_data(uint32_t index, std::string frame) {
+    if (closed_) return;
+    if (frame.size() < chunk_header_size || (uint8_t)frame[0] != frame_chunk) {
+      ASIO_NET_LOGE("striped: invalid frame, size: %zu", frame.size());
+      close();
+      return;
+    }
+    uint64_t seq;
+    std::memcpy(&seq, &frame[1], sizeof(seq));
+    if (seq < recv_seq_) {
+      ASIO_NET_LOGE("striped: duplicate chunk: %llu", (unsigned long long)seq);
+      close();
+      return;
+    }
+    if (seq - recv_seq_ >= recv_window_) {
+      ASIO_NET_LOGE("striped: chunk out of window: %llu, expect: %llu", (unsigned long long)seq, (unsigned long long)recv_seq_);
+      close();
+      return;
+    }
+    if (recv_chunks_bytes_ + frame.size() > config_.max_recv_buffer) {
+      ASIO_NET_LOGE("striped: recv buffer full: %zu", recv_chunks_bytes_);
+      close();
+      return;
+    }
+    auto size = frame.size();
+    if (!recv_chunks_.emplace(seq, std::move(frame)).second) {
+      ASIO_NET_LOGE("striped: duplicate chunk: %llu", (unsigned long long)seq);
+      close();
+      return;
+    }
+    recv_chunks_bytes_ += size;
+    // stripes carry seq round-robin, pause the one running ahead before its next chunk falls out of window
+    if (seq + stripes_.size() - recv_seq_ >= recv_window_ && index < stripes_.size()) {
+      auto stripe = stripes_[index].lock();
+      if (stripe) {
+        stripe->pause_read();
+        stripe_recv_[index] = {seq, true};
+      }
+    }
+    deliver();
+  }
+
+ protected:
+  /**
+   * clear state of last session, for open again after closed
+   */
+  void reset() {
+    ready_ = false;
+    closed_ = false;
+    send_seq_ = 0;
+    send_index_ = 0;
+    recv_seq_ = 0;
+    recv_chunks_.clear();
+    recv_chunks_bytes_ = 0;
+    recv_msg_.clear();
+    for (uint32_t i = 0; i < stripes_.size(); ++i) {
+      if (!stripe_recv_[i].paused) continue;
+      stripe_recv_[i].paused = false;
+      auto stripe = stripes_[i].lock();
+      if (stripe) stripe->resume_read();
+    }
+  }
+
+  bool is_closed() const {
+    return closed_;
+  }
+
+ private:
+  void deliver() {
+    if (!ready_) return;
+    for (auto it = recv_chunks_.begin(); it != recv_chunks_.end() && it->first == recv_seq_; it = recv_chunks_.begin()) {
+      auto frame = std::move(it->second);
+      recv_chunks_.erase(it);
+      recv_chunks_bytes_ -= frame.size();
+      recv_seq_ += 1;
+      bool last = frame[9] & 1;
+      if (recv_msg_.size() + (frame.size() - chunk_header_size) > config_.max_message_size) {
+        ASIO_NET_LOGE("striped: message too large: %zu", recv_msg_.size() + (frame.size() - chunk_header_size));
+        close();
+        return;
+      }
+      if (recv_msg_.empty() && last) {
+        // single chunk, avoid copy to recv_msg_
+        frame.erase(0, chunk_header_size);
+        if (on_data) on_data(std::move(frame));
+      } else {
+        recv_msg_.append(frame, chunk_header_size, std::string::npos);
+        if (last) {
+          auto msg = std::move(recv_msg_);
+          recv_msg_.clear();
+          if (on_data) on_data(std::move(msg));
+        }
+      }
+      if (closed_) return;
+    }
+    resume_stripes();
+  }
+
+  void resume_stripes() {
+    for (uint32_t i = 0; i < stripes_.size(); ++i) {
+      auto& recv = stripe_recv_[i];
+      if (!recv.paused || recv.last_seq + stripes_.size() - recv_seq_ >= recv_window_) continue;
+      recv.paused = false;
+      auto stripe = stripes_[i].lock();
+      if (stripe) stripe->resume_read();
+    }
+  }
+
+ public:
+  std::function<void(std::string)> on_data;
+  std::function<void()> on_close;
+
+ private:
+  std::vector<std::weak_ptr<tcp_channel_t<T>>> stripes_;
+  uint32_t chunk_size_;
+  striped_config config_;
+  uint32_t joined_num_ = 0;
+  bool ready_ = false;
+  bool closed_ = false;
+
+  uint64_t send_seq_ = 0;
+  uint32_t send_index_ = 0;
+
+  struct stripe_recv {
+    uint64_t last_seq = 0;
+    bool paused = false;
+  };
+  uint64_t recv_window_;
+  std::vector<stripe_recv> stripe_recv_;
+  uint64_t recv_seq_ = 0;
+  std::map<uint64_t, std::string> recv_chunks_;
+  size_t recv_chunks_bytes_ = 0;
+  std::string recv_msg_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "noncopyable.hpp"
+#include "striped_channel_t.hpp"
+#include "tcp_client_t.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * open `stripe_num` tcp connections to the same striped_server, and use them as one channel
+ * for large transfers over high-BDP links which a single tcp connection can not fill
+ */
+template <socket_type T>
+class striped_client_t : public striped_channel_t<T> {
+ public:
+  /**
+   * @param executor io_context or any executor, stripes share one strand if it is concurrent
+   */
+  explicit striped_client_t(io_executor executor, striped_config striped_config = {}, tcp_config tcp_config = {})
+      : striped_channel_t<T>(striped_config.stripe_num, striped_config), executor_(executor.make_strand()) {
+    tcp_config.auto_pack = true;
+    for (uint32_t i = 0; i < this->stripe_num(); ++i) {
+      clients_.emplace_back(std::make_shared<tcp_client_t<T>>(executor_, tcp_config));
+    }
+    init();
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  explicit striped_client_t(io_executor executor, asio::ssl::context& ssl_context, striped_config striped_config = {}, tcp_config tcp_config = {})
+      : striped_channel_t<T>(striped_config.stripe_num, striped_config), executor_(executor.make_strand()) {
+    tcp_config.auto_pack = true;
+    for (uint32_t i = 0; i < this->stripe_num(); ++i) {
+      clients_.emplace_back(std::make_shared<tcp_client_t<T>>(executor_, ssl_context, tcp_config));
+    }
+    init();
+  }
+#endif
+
+  /**
+   * connect to server, can be opened again after closed, as a new session on server
+   *
+   * @param host A string identifying a location. May be a descriptive name or a numeric address string.
+   * @param port The port to open.
+   */
+  void open(const std::string& host, uint16_t port) {
+    static_assert(T == socket_type::normal || T == socket_type::ssl, "");
+    renew();
+    for (auto& client : clients_) {
+      client->open(host, port);
+    }
+  }
+
+  /**
+   * connect to domain socket
+   *
+   * @param endpoint e.g. /tmp/foobar
+   */
+  void open(const std::string& endpoint) {
+    static_assert(T == socket_type::domain, "");
+    renew();
+    for (auto& client : clients_) {
+      client->open(endpoint);
+    }
+  }
+
+  /**
+   * run io_context until stop, not available for other executors
+   */
+  void run() {
+    auto io_context = executor_.io_context();
+    if (!io_context) {
+      ASIO_NET_LOGE("run: needs io_context");
+      return;
+    }
+    auto work = asio::make_work_guard(*io_context);
+    io_context->run();
+  }
+
+  void stop() {
+    this->close();
+    if (executor_.io_context()) executor_.io_context()->stop();
+  }
+
+ private:
+  static uint64_t make_group_id() {
+    std::random_device rd;
+    std::mt19937_64 gen(((uint64_t)rd() << 32) | rd());
+    return gen();
+  }
+
+  /**
+   * start from a clean state if last session closed, with a new group id
+   */
+  void renew() {
+    if (!this->is_closed()) return;
+    this->reset();
+    group_id_ = make_group_id();
+    open_num_ = 0;
+    open_failed_ = false;
+  }
+
+  void init() {
+    group_id_ = make_group_id();
+    auto stripe_num = (uint32_t)clients_.size();
+    for (uint32_t i = 0; i < stripe_num; ++i) {
+      auto& client = clients_[i];
+      this->set_stripe(i, client);
+      client->on_open = [this, client = client.get(), stripe_num, i] {
+        client->send(this->make_hello(group_id_, stripe_num, i));
+        if (++open_num_ == stripe_num) {
+          this->set_ready();
+          if (on_open) on_open();
+        }
+      };
+      client->on_open_failed = [this](std::error_code ec) {
+        this->close();
+        if (open_failed_) return;
+        open_failed_ = true;
+        if (on_open_failed) on_open_failed(ec);
+      };
+      client->on_data = [this, i](std::string data) {
+        this->on_stripe_data(i, std::move(data));
+      };
+      client->on_close = [this] {
+        this->close();
+      };
+    }
+  }
+
+ public:
+  std::function<void()> on_open;
+  std::function<void(std::error_code)> on_open_failed;
+
+ private:
+  io_executor executor_;
+  std::vector<std::shared_ptr<tcp_client_t<T>>> clients_;
+  uint64_t group_id_ = 0;
+  uint32_t open_num_ = 0;
+  bool open_failed_ = false;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "asio.hpp"
+#include "striped_channel_t.hpp"
+#include "tcp_server_t.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * accept connections from striped_client, group them by hello and reassemble as one session
+ */
+template <socket_type T>
+class striped_server_t : private noncopyable {
+  using session = striped_channel_t<T>;
+
+ public:
+  striped_server_t(io_executor executor, uint16_t port, striped_config striped_config = {}, tcp_config tcp_config = {})
+      : executor_(executor.make_strand()), striped_config_(striped_config), server_(executor_, port, init_tcp_config(tcp_config)) {
+    static_assert(T == detail::socket_type::normal, "");
+    init();
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  striped_server_t(io_executor executor, uint16_t port, asio::ssl::context& ssl_context, striped_config striped_config = {},
+                   tcp_config tcp_config = {})
+      : executor_(executor.make_strand()), striped_config_(striped_config), server_(executor_, port, ssl_context, init_tcp_config(tcp_config)) {
+    static_assert(T == detail::socket_type::ssl, "");
+    init();
+  }
+#endif
+
+  striped_server_t(io_executor executor, const std::string& endpoint, striped_config striped_config = {}, tcp_config tcp_config = {})
+      : executor_(executor.make_strand()), striped_config_(striped_config), server_(executor_, endpoint, init_tcp_config(tcp_config)) {
+    static_assert(T == detail::socket_type::domain, "");
+    init();
+  }
+
+ public:
+  void start(bool loop = false) {
+    server_.start(loop);
+  }
+
+ private:
+  static tcp_config init_tcp_config(tcp_config config) {
+    config.auto_pack = true;
+    return config;
+  }
+
+  // per tcp session
+  struct stripe_state {
+    uint64_t group_id = 0;
+    uint32_t index = 0;
+    std::shared_ptr<session> group;
+  };
+
+  void init() {
+    server_.on_session = [this](std::weak_ptr<tcp_session_t<T>> ws) {
+      auto tcp_session = ws.lock();
+      auto state = std::make_shared<stripe_state>();
+      tcp_session->on_data = [this, ws, state](std::string data) {
+        if (state->group) {
+          state->group->on_stripe_data(state->index, std::move(data));
+        } else {
+          on_hello(ws, *state, data);
+        }
+      };
+      tcp_session->on_close = [this, state] {
+        if (!state->group) return;
+        auto group = std::move(state->group);
+        remove_group(state->group_id, group);
+        group->close();
+      };
+    };
+  }
+
+  void on_hello(const std::weak_ptr<tcp_session_t<T>>& ws, stripe_state& state, const std::string& data) {
+    uint64_t group_id;
+    uint32_t stripe_num;
+    uint32_t index;
+    if (!session::parse_hello(data, group_id, stripe_num, index) || stripe_num > striped_config_.stripe_num) {
+      ASIO_NET_LOGE("striped: invalid hello");
+      ws.lock()->close();
+      return;
+    }
+
+    auto& group = groups_[group_id];
+    if (!group) {
+      group = std::make_shared<session>(stripe_num, striped_config_);
+    }
+    if (group->stripe_num() != stripe_num || !group->set_stripe(index, ws)) {
+      ASIO_NET_LOGE("striped: hello mismatch");
+      ws.lock()->close();
+      return;
+    }
+    state.group_id = group_id;
+    state.index = index;
+    state.group = group;
+
+    if (group->is_complete()) {
+      group->set_ready();
+      if (on_session) on_session(group);
+    }
+  }
+
+  void remove_group(uint64_t group_id, const std::shared_ptr<session>& group) {
+    auto it = groups_.find(group_id);
+    if (it != groups_.cend() && it->second == group) {
+      // post delay destroy, ensure session callback finish
+      asio::post(executor_.get(), [group = std::move(it->second)] {});
+      groups_.erase(it);
+    }
+  }
+
+ public:
+  std::function<void(std::weak_ptr<session>)> on_session;
+
+ private:
+  // stripes of a group may be accepted on any session, serialized by one strand if executor is concurrent
+  io_executor executor_;
+  striped_config striped_config_;
+  detail::tcp_server_t<T> server_;
+  std::unordered_map<uint64_t, std::shared_ptr<session>> groups_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -1,20 +1,64 @@
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <utility>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "../config.hpp"
 #include "asio.hpp"
+#include "io_executor.hpp"
 #include "log.h"
 #include "message.hpp"
 #include "noncopyable.hpp"
+#include "socket_option.hpp"
 #include "socket_type.hpp"
+#include "tcp_info.hpp"
+#include "token_bucket.hpp"
 
 namespace asio_net {
+
+struct tcp_stats {
+  uint64_t send_messages = 0;
+  uint64_t send_bytes = 0;
+  uint64_t recv_messages = 0;
+  uint64_t recv_bytes = 0;
+  // messages dropped by send deadline
+  uint64_t send_expired_messages = 0;
+  uint64_t send_expired_bytes = 0;
+  // last sample of kernel tcp info, @see tcp_config::tcp_info_interval_ms
+  tcp_metrics tcp_info;
+};
+
 namespace detail {
 
 template <socket_type T>
 class tcp_channel_t : private noncopyable {
+  using clock = std::chrono::steady_clock;
+
+  struct write_msg {
+    std::string body;
+    std::shared_ptr<const std::string> shared_body;  // shared by channels, e.g. broadcast
+    clock::time_point deadline;
+    uint32_t length = 0;  // header when auto_pack
+
+    const std::string& data() const {
+      return shared_body ? *shared_body : body;
+    }
+  };
+
+  // allocated on first migrate or hook, most channels never move
+  struct migrate_state {
+    bool running = false;
+    asio::any_io_executor executor;
+    std::function<void(bool)> handle;
+    std::function<void()> moved;
+    std::function<void()> hook;
+  };
+
  public:
   tcp_channel_t(typename socket_impl<T>::socket& socket, const tcp_config& config) : socket_(socket), config_(config) {
     ASIO_NET_LOGD("tcp_channel: %p", this);
@@ -34,6 +78,12 @@ class tcp_channel_t : private noncopyable {
       asio::socket_base::receive_buffer_size option(config_.socket_recv_buffer_size);
       get_socket().set_option(option);
     }
+    apply_tcp_options(get_socket(), config_);
+    send_bucket_ = config_.send_rate_limit ? std::make_unique<token_bucket>(config_.send_rate_limit, config_.send_rate_burst) : nullptr;
+    recv_bucket_ = config_.recv_rate_limit ? std::make_unique<token_bucket>(config_.recv_rate_limit, config_.recv_rate_burst) : nullptr;
+    if (config_.tcp_info_interval_ms) {
+      do_sample_tcp_info();
+    }
   }
 
   inline auto& get_socket() const {
@@ -49,13 +99,38 @@ class tcp_channel_t : private noncopyable {
   /**
    * async send message
    * 1. will close if error occur, e.g. msg.size() > max_body_size
-   * 2. will block wait if send buffer > max_send_buffer_size
-   * 3. not threadsafe, only can be used on io_context thread
+   * 2. will block wait if send buffer > max_send_buffer_size, on io_context only, @see io_executor
+   * 3. not threadsafe, only can be used on io_context thread, or strand of the channel
    *
    * @param msg can be string or binary
    */
   void send(std::string msg) {
-    do_write(std::move(msg), false);
+    do_write({std::move(msg), nullptr, clock::time_point::max()}, false);
+  }
+
+  /**
+   * async send shared message, the buffer will not be copied
+   * e.g. send one message to many channels
+   *
+   * @param msg can be string or binary, should not be modified until sent
+   */
+  void send(std::shared_ptr<const std::string> msg) {
+    do_write({{}, std::move(msg), clock::time_point::max()}, false);
+  }
+
+  /**
+   * async send message with deadline
+   * message still in queue when deadline reached will be dropped, and counted in @see`stats`
+   *
+   * @param msg can be string or binary
+   * @param deadline
+   */
+  void send(std::string msg, clock::time_point deadline) {
+    do_write({std::move(msg), nullptr, deadline}, false);
+  }
+
+  void send(std::string msg, std::chrono::milliseconds expire) {
+    do_write({std::move(msg), nullptr, clock::now() + expire}, false);
   }
 
   /**
@@ -66,10 +141,164 @@ class tcp_channel_t : private noncopyable {
     do_close();
   }
 
+  /**
+   * close after queued messages sent, or timeout reached
+   * will trigger @see`on_close` if opened
+   */
+  void flush_and_close(std::chrono::milliseconds timeout) {
+    if (!is_open()) return;
+    if (send_buffer_now_ == 0) {
+      do_close();
+      return;
+    }
+    flush_closing_ = true;
+    if (!close_timer_) {
+      close_timer_ = std::make_unique<asio::steady_timer>(socket_.get_executor());
+    }
+    close_timer_->expires_after(timeout);
+    close_timer_->async_wait([this, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) {
+      if (alive.expired() || ec) return;
+      ASIO_NET_LOGD("flush_and_close: timeout, unsent: %zu", send_buffer_now_);
+      do_close();
+    });
+  }
+
   bool is_open() const {
     return get_socket().is_open();
   }
 
+  /**
+   * bytes queued by send but not written to socket yet
+   */
+  size_t send_buffer_size() const {
+    return send_buffer_now_;
+  }
+
+  /**
+   * stop reading from socket, let tcp flow control push back on the sender
+   * the message being read will be finished, and no more @see`on_data` until `resume_read`
+   * NOTICE: peer close can not be detected while paused
+   */
+  void pause_read() {
+    read_paused_ = true;
+  }
+
+  void resume_read() {
+    read_paused_ = false;
+    try_resume_read();
+  }
+
+  bool is_read_paused() const {
+    return read_paused_ || read_paused_by_backlog_;
+  }
+
+  /**
+   * report the bytes/messages received but not consumed yet by application
+   * will pause read when backlog >= read_backlog_high, and resume when backlog <= read_backlog_low
+   */
+  void set_read_backlog(uint32_t backlog) {
+    if (config_.read_backlog_high == UINT32_MAX) return;
+    if (backlog >= config_.read_backlog_high) {
+      read_paused_by_backlog_ = true;
+    } else if (backlog <= config_.read_backlog_low) {
+      read_paused_by_backlog_ = false;
+      try_resume_read();
+    }
+  }
+
+  const tcp_stats& stats() const {
+    return stats_;
+  }
+
+  /**
+   * snapshot of kernel tcp metrics, e.g. rtt, cwnd, retransmits
+   * tell whether a slow session is bound by network or application
+   * NOTICE: invalid for domain socket
+   */
+  tcp_metrics tcp_info() const {
+    return get_tcp_metrics(get_socket());
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  /**
+   * ssl only, handshake resumed a previous session instead of a full one, @see tcp_config::ssl_session_resumption
+   */
+  bool ssl_session_reused() {
+    static_assert(T == socket_type::ssl, "");
+    return SSL_session_reused(socket_.native_handle()) == 1;
+  }
+#endif
+
+  /**
+   * executor which channel handlers run on, e.g. io_context or strand of a thread pool
+   */
+  asio::any_io_executor get_executor() const {
+    return socket_.get_executor();
+  }
+
+  /**
+   * io_context which channel handlers run on
+   * @throw std::logic_error if not running on io_context, e.g. asio::thread_pool, @see get_executor
+   */
+  asio::io_context& get_io_context() const {
+    return io_executor(socket_.get_executor()).get_io_context();
+  }
+
+  /**
+   * move channel to another executor, e.g. a less loaded io_context of io_context_pool
+   * socket is released and re-registered, messages sent while migrating are queued and handed over
+   * NOTICE:
+   * 1. call on current executor of channel, not in on_data, all later callbacks run on new executor
+   * 2. posix only, ssl not supported: ssl stream holds timers of current executor
+   * 3. only quiescent channel can be migrated: nothing being sent, read waiting on socket or paused
+   *
+   * @param executor
+   * @param handle called with true on new executor when done, or with false if closed while migrating
+   * @param moved called on old executor right after socket moved, e.g. publish new executor to other threads
+   * @return false if not supported or not quiescent now, handle will not be called
+   */
+  bool migrate(io_executor executor, std::function<void(bool)> handle = nullptr, std::function<void()> moved = nullptr) {
+#ifdef _WIN32
+    (void)executor;
+    (void)handle;
+    (void)moved;
+    ASIO_NET_LOGW("migrate: not supported");
+    return false;
+#else
+    if (T == socket_type::ssl || !is_open() || is_migrating() || flush_closing_ || send_buffer_now_ != 0) return false;
+    if (!read_pending_ && !(read_resume_ && is_read_paused())) return false;
+    if (!migrate_) migrate_ = std::make_unique<migrate_state>();
+    migrate_->running = true;
+    migrate_->executor = executor.get();
+    migrate_->handle = std::move(handle);
+    migrate_->moved = std::move(moved);
+    if (read_pending_) {
+      // read handler continues by finish_migrate
+      asio::error_code ec;
+      get_socket().cancel(ec);
+    } else {
+      asio::post(socket_.get_executor(), [this, alive = std::weak_ptr<void>(this->is_alive_)] {
+        if (alive.expired()) return;
+        finish_migrate(nullptr);
+      });
+    }
+    return true;
+#endif
+  }
+
+  bool is_migrating() const {
+    return migrate_ && migrate_->running;
+  }
+
+  /**
+   * called on the old executor right after socket moved by migrate, before anything runs on new executor
+   * e.g. upper layer moves its own timers, @see rpc_session_t
+   */
+  void set_migrate_hook(std::function<void()> hook) {
+    if (!migrate_) migrate_ = std::make_unique<migrate_state>();
+    migrate_->hook = std::move(hook);
+  }
+
   typename socket_impl<T>::endpoint local_endpoint() {
     return socket_.local_endpoint();
   }
@@ -80,7 +309,17 @@ class tcp_channel_t : private noncopyable {
 
  protected:
   void do_read_start(std::shared_ptr<tcp_channel_t> self = nullptr) {
-    if (config_.auto_pack) {
+    if (is_read_paused()) {
+      read_resume_ = [this, self = std::move(self)]() mutable {
+        do_read_start(std::move(self));
+      };
+      return;
+    }
+    if (is_lazy_read()) {
+      asio::error_code ec;
+      get_socket().non_blocking(true, ec);
+      do_wait_read(std::move(self));
+    } else if (config_.auto_pack) {
       do_read_header(std::move(self));
     } else {
       // init read_msg_.body as buffer
@@ -90,13 +329,191 @@ class tcp_channel_t : private noncopyable {
   }
 
  private:
-  void do_read_header(std::shared_ptr<tcp_channel_t> self) {
+  void try_resume_read() {
+    if (is_read_paused() || !read_resume_) return;
+    auto next = std::move(read_resume_);
+    read_resume_ = nullptr;
+    // post to avoid reentry when called in on_data
+    asio::post(socket_.get_executor(), [next = std::move(next), alive = std::weak_ptr<void>(this->is_alive_)] {
+      if (alive.expired()) return;
+      next();
+    });
+  }
+
+  bool is_lazy_read() const {
+    return config_.lazy_read && T != socket_type::ssl;
+  }
+
+  /**
+   * count read budget of current turn, a turn is the reads back-to-back without waiting for the socket
+   * @return true if budget exhausted, should yield io thread to other sessions
+   */
+  bool consume_read_budget(size_t bytes) {
+    if (config_.read_budget_messages == 0 && config_.read_budget_bytes == 0) return false;
+    read_budget_messages_ += 1;
+    read_budget_bytes_ += bytes;
+    bool exhausted = (config_.read_budget_messages != 0 && read_budget_messages_ >= config_.read_budget_messages) ||
+                     (config_.read_budget_bytes != 0 && read_budget_bytes_ >= config_.read_budget_bytes);
+    // kernel buffer drained, next read waits for the socket and the turn ends
+    asio::error_code ec;
+    if (exhausted || get_socket().available(ec) == 0) {
+      read_budget_messages_ = 0;
+      read_budget_bytes_ = 0;
+    }
+    return exhausted;
+  }
+
+  using read_handler = void (tcp_channel_t::*)(std::shared_ptr<tcp_channel_t>);
+
+  /**
+   * check pause, recv rate limit and read budget before next read
+   * @return true if can read immediately, otherwise `next` will be called later
+   */
+  bool check_read_continue(std::shared_ptr<tcp_channel_t>& self, read_handler next, size_t bytes) {
+    auto wait = consume_bucket(recv_bucket_.get(), config_.shared_recv_bucket.get(), bytes);
+    if (is_read_paused()) {
+      read_resume_ = [this, self = std::move(self), next]() mutable {
+        (this->*next)(std::move(self));
+      };
+      return false;
+    }
+    if (wait != clock::duration::zero()) {
+      if (!read_timer_) {
+        read_timer_ = std::make_unique<asio::steady_timer>(socket_.get_executor());
+      }
+      read_timer_->expires_after(wait);
+      read_timer_->async_wait([this, self = std::move(self), next, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) mutable {
+        if (alive.expired() || ec) return;
+        (this->*next)(std::move(self));
+      });
+      return false;
+    }
+    if (consume_read_budget(bytes)) {
+      asio::post(socket_.get_executor(), [this, self = std::move(self), next, alive = std::weak_ptr<void>(this->is_alive_)]() mutable {
+        if (alive.expired()) return;
+        (this->*next)(std::move(self));
+      });
+      return false;
+    }
+    return true;
+  }
+
+  void do_read_continue(std::shared_ptr<tcp_channel_t> self, read_handler next, size_t bytes) {
+    if (check_read_continue(self, next, bytes)) {
+      (this->*next)(std::move(self));
+    }
+  }
+
+  /**
+   * consume tokens from channel and shared bucket
+   * @return time need to wait before next read/write
+   */
+  static clock::duration consume_bucket(token_bucket* bucket, token_bucket* shared_bucket, size_t bytes) {
+    auto wait = clock::duration::zero();
+    for (auto b : {bucket, shared_bucket}) {
+      if (b) {
+        b->consume(bytes);
+        wait = std::max(wait, b->wait_time());
+      }
+    }
+    return wait;
+  }
+
+  void do_read_next(std::shared_ptr<tcp_channel_t> self) {
+    if (is_lazy_read()) {
+      // data may already in kernel buffer, and will not trigger readable again
+      asio::error_code ec;
+      if (get_socket().available(ec) == 0 && !ec) {
+        do_wait_read(std::move(self));
+        return;
+      }
+    }
+    do_read_header(std::move(self));
+  }
+
+  void do_wait_read(std::shared_ptr<tcp_channel_t> self) {
+    if (is_migrating()) {
+      finish_migrate([this, self]() mutable {
+        do_wait_read(std::move(self));
+      });
+      return;
+    }
+    read_pending_ = true;
+    get_socket().async_wait(asio::socket_base::wait_read,
+                            [this, self = std::move(self), alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) mutable {
+                              if (alive.expired()) return;
+                              read_pending_ = false;
+                              if (ec == asio::error::operation_aborted && is_migrating()) {
+                                do_wait_read(std::move(self));
+                                return;
+                              }
+                              if (ec) {
+                                ASIO_NET_LOGD("do_wait_read: %s", ec.message().c_str());
+                                do_close();
+                                return;
+                              }
+                              if (config_.auto_pack) {
+                                do_read_header(std::move(self));
+                              } else {
+                                do_read_data_lazy(std::move(self));
+                              }
+                            });
+  }
+
+  void do_read_data_lazy(std::shared_ptr<tcp_channel_t> self) {
+    std::weak_ptr<void> alive = this->is_alive_;
+    auto& buffer = shared_read_buffer(config_.max_body_size);
+    for (;;) {
+      asio::error_code ec;
+      auto length = socket_.read_some(asio::buffer(&buffer[0], config_.max_body_size), ec);
+      if (ec == asio::error::would_block) {
+        break;
+      } else if (ec) {
+        ASIO_NET_LOGD("do_read_data_lazy: %s", ec.message().c_str());
+        do_close();
+        return;
+      }
+      stats_.recv_messages += 1;
+      stats_.recv_bytes += length;
+      if (on_data) on_data(std::string(buffer.data(), length));
+      if (alive.expired() || !is_open()) return;
+      // short read means kernel buffer is drained
+      bool drained = length < config_.max_body_size;
+      if (!check_read_continue(self, drained ? &tcp_channel_t::do_wait_read : &tcp_channel_t::do_read_data_lazy, length)) return;
+      if (drained) break;
+    }
+    do_wait_read(std::move(self));
+  }
+
+  static std::string& shared_read_buffer(uint32_t size) {
+    static thread_local std::string buffer;
+    if (buffer.size() < size) {
+      buffer.resize(size);
+    }
+    return buffer;
+  }
+
+  /**
+   * @param offset bytes already read, read continues after migrate
+   */
+  void do_read_header(std::shared_ptr<tcp_channel_t> self, size_t offset = 0) {
+    if (is_migrating()) {
+      finish_migrate([this, self, offset]() mutable {
+        do_read_header(std::move(self), offset);
+      });
+      return;
+    }
+    read_pending_ = true;
     asio::async_read(
-        socket_, asio::buffer(&read_msg_.length, sizeof(read_msg_.length)),
-        [this, self = std::move(self), alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec, std::size_t size) mutable {
+        socket_, asio::buffer((char*)&read_msg_.length + offset, sizeof(read_msg_.length) - offset),
+        [this, self = std::move(self), offset, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec, std::size_t size) mutable {
           if (alive.expired()) return;
+          read_pending_ = false;
 
-          if (ec == asio::error::eof || ec == asio::error::connection_reset) {
+          if (ec == asio::error::operation_aborted && is_migrating()) {
+            do_read_header(std::move(self), offset + size);
+            return;
+          } else if (ec == asio::error::eof || ec == asio::error::connection_reset) {
             do_close();
             return;
           } else if (ec || size == 0) {
@@ -114,14 +531,28 @@ class tcp_channel_t : private noncopyable {
         });
   }
 
-  void do_read_body(std::shared_ptr<tcp_channel_t> self) {
-    read_msg_.body.resize(read_msg_.length);
+  /**
+   * @param offset bytes already read, read continues after migrate
+   */
+  void do_read_body(std::shared_ptr<tcp_channel_t> self, size_t offset = 0) {
+    if (is_migrating()) {
+      finish_migrate([this, self, offset]() mutable {
+        do_read_body(std::move(self), offset);
+      });
+      return;
+    }
+    if (offset == 0) read_msg_.body.resize(read_msg_.length);
+    read_pending_ = true;
     asio::async_read(
-        socket_, asio::buffer(read_msg_.body),
-        [this, self = std::move(self), alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec, std::size_t size) mutable {
+        socket_, asio::buffer(&read_msg_.body[offset], read_msg_.length - offset),
+        [this, self = std::move(self), offset, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec, std::size_t size) mutable {
           if (alive.expired()) return;
+          read_pending_ = false;
 
-          if (ec == asio::error::eof || ec == asio::error::connection_reset) {
+          if (ec == asio::error::operation_aborted && is_migrating()) {
+            do_read_body(std::move(self), offset + size);
+            return;
+          } else if (ec == asio::error::eof || ec == asio::error::connection_reset) {
             do_close();
             return;
           } else if (ec || size == 0) {
@@ -132,84 +563,238 @@ class tcp_channel_t : private noncopyable {
 
           auto msg = std::move(read_msg_.body);
           read_msg_.clear();
+          stats_.recv_messages += 1;
+          stats_.recv_bytes += offset + size;
           if (on_data) on_data(std::move(msg));
-          do_read_header(std::move(self));
+          do_read_continue(std::move(self), &tcp_channel_t::do_read_next, offset + size);
         });
   }
 
   void do_read_data(std::shared_ptr<tcp_channel_t> self) {
+    if (is_migrating()) {
+      finish_migrate([this, self]() mutable {
+        do_read_data(std::move(self));
+      });
+      return;
+    }
+    read_pending_ = true;
     auto& readBuffer = read_msg_.body;
     socket_.async_read_some(asio::buffer(readBuffer), [this, self = std::move(self), alive = std::weak_ptr<void>(this->is_alive_)](
                                                           const std::error_code& ec, std::size_t length) mutable {
       if (alive.expired()) return;
+      read_pending_ = false;
+      if (ec == asio::error::operation_aborted && is_migrating()) {
+        do_read_data(std::move(self));
+        return;
+      }
       if (!ec) {
+        stats_.recv_messages += 1;
+        stats_.recv_bytes += length;
         if (on_data) on_data(std::string(read_msg_.body.data(), length));
-        do_read_data(std::move(self));
+        do_read_continue(std::move(self), &tcp_channel_t::do_read_data, length);
       } else {
         do_close();
       }
     });
   }
 
-  void do_write(std::string msg, bool from_queue) {
-    if (config_.auto_pack && msg.size() > config_.max_body_size) {
-      ASIO_NET_LOGE("write: body size=%zu > max_body_size=%u", msg.size(), config_.max_body_size);
+  void do_write(write_msg msg, bool from_queue) {
+    auto size = msg.data().size();
+    if (config_.auto_pack && size > config_.max_body_size) {
+      ASIO_NET_LOGE("write: body size=%zu > max_body_size=%u", size, config_.max_body_size);
       do_close();
     }
 
-    if (msg.size() > config_.max_send_buffer_size) {
-      ASIO_NET_LOGE("write: body size=%zu > max_send_buffer_size=%u", msg.size(), config_.max_send_buffer_size);
+    if (size > config_.max_send_buffer_size) {
+      ASIO_NET_LOGE("write: body size=%zu > max_send_buffer_size=%u", size, config_.max_send_buffer_size);
       do_close();
     }
 
-    // block wait send_buffer idle
-    while (msg.size() + send_buffer_now_ > config_.max_send_buffer_size) {
+    // block wait send_buffer idle, msg from queue is already counted
+    // only a plain io_context can be run here, handlers on strand or thread pool can not, queue beyond the limit instead
+    while (!from_queue && size + send_buffer_now_ > config_.max_send_buffer_size) {
       if (!is_open()) {
         ASIO_NET_LOGE("write: socket closed");
         return;
       }
+      io_executor executor(socket_.get_executor());
+      if (executor.is_concurrent() || is_migrating()) {
+        ASIO_NET_LOGD("write: send_buffer full, can not block on executor");
+        break;
+      }
       ASIO_NET_LOGV("block wait send_buffer idle");
-      static_cast<asio::io_context*>(&socket_.get_executor().context())->run_one();
+      executor.io_context()->run_one();
     }
 
-    // queue for asio::async_write
-    if (!from_queue && send_buffer_now_ != 0) {
+    // queue for asio::async_write, or hand over to new executor when migrating
+    if (!from_queue && (send_buffer_now_ != 0 || is_migrating())) {
       ASIO_NET_LOGV("queue for asio::async_write");
-      send_buffer_now_ += msg.size();
-      write_msg_queue_.emplace_back(std::move(msg));
+      send_buffer_now_ += size;
+      if (!write_msg_queue_) write_msg_queue_ = std::make_unique<std::deque<write_msg>>();
+      write_msg_queue_->push_back(std::move(msg));
       return;
     }
     if (!from_queue) {
-      send_buffer_now_ += msg.size();
+      send_buffer_now_ += size;
+    }
+
+    if (msg.deadline != clock::time_point::max() && clock::now() >= msg.deadline) {
+      drop_expired(size);
+      do_write_next();
+      return;
+    }
+
+    // pace by send rate limit, msg is counted in send_buffer_now_ and will be sent after timer
+    if (send_bucket_ || config_.shared_send_bucket) {
+      auto wait = clock::duration::zero();
+      for (auto b : {send_bucket_.get(), config_.shared_send_bucket.get()}) {
+        if (b) wait = std::max(wait, b->wait_time());
+      }
+      if (wait != clock::duration::zero()) {
+        if (!write_timer_) {
+          write_timer_ = std::make_unique<asio::steady_timer>(socket_.get_executor());
+        }
+        write_timer_->expires_after(wait);
+        write_timer_->async_wait([this, msg = std::move(msg), alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) mutable {
+          if (alive.expired() || ec) return;
+          do_write(std::move(msg), true);
+        });
+        return;
+      }
+      consume_bucket(send_bucket_.get(), config_.shared_send_bucket.get(), size);
     }
 
-    auto keeper = std::make_unique<detail::message>(std::move(msg));
+    auto keeper = std::make_unique<write_msg>(std::move(msg));
+    keeper->length = (uint32_t)size;
     std::vector<asio::const_buffer> buffer;
     if (config_.auto_pack) {
       buffer.emplace_back(&keeper->length, sizeof(keeper->length));
     }
-    buffer.emplace_back(asio::buffer(keeper->body));
+    buffer.emplace_back(asio::buffer(keeper->data()));
     asio::async_write(
         socket_, buffer,
         [this, keeper = std::move(keeper), alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec, std::size_t /*length*/) {
           if (alive.expired()) return;
-          send_buffer_now_ -= keeper->body.size();
+          send_buffer_now_ -= keeper->length;
           if (ec) {
             do_close();
-          }
-
-          if (!write_msg_queue_.empty()) {
-            asio::post(socket_.get_executor(), [this, msg = std::move(write_msg_queue_.front())]() mutable {
-              do_write(std::move(msg), true);
-            });
-            write_msg_queue_.pop_front();
           } else {
-            write_msg_queue_.shrink_to_fit();
+            stats_.send_messages += 1;
+            stats_.send_bytes += keeper->length;
           }
+          do_write_next();
         });
   }
 
+  void do_write_next() {
+    auto& queue = write_msg_queue_;
+    // drop expired messages before they hit the wire
+    if (queue && !queue->empty()) {
+      auto now = clock::now();
+      while (!queue->empty() && now >= queue->front().deadline) {
+        auto size = queue->front().data().size();
+        queue->pop_front();
+        drop_expired(size);
+      }
+    }
+
+    if (queue && !queue->empty()) {
+      asio::post(socket_.get_executor(), [this, msg = std::move(queue->front()), alive = std::weak_ptr<void>(this->is_alive_)]() mutable {
+        if (alive.expired()) return;
+        do_write(std::move(msg), true);
+      });
+      queue->pop_front();
+    } else {
+      // idle channel holds no queue memory
+      queue = nullptr;
+      if (flush_closing_ && send_buffer_now_ == 0) do_close();
+    }
+  }
+
+  void drop_expired(size_t size) {
+    ASIO_NET_LOGV("drop expired message: size=%zu", size);
+    send_buffer_now_ -= size;
+    stats_.send_expired_messages += 1;
+    stats_.send_expired_bytes += size;
+  }
+
+  void do_sample_tcp_info() {
+    stats_.tcp_info = tcp_info();
+    if (!info_timer_) {
+      info_timer_ = std::make_unique<asio::steady_timer>(socket_.get_executor());
+    }
+    info_timer_->expires_after(std::chrono::milliseconds(config_.tcp_info_interval_ms));
+    info_timer_->async_wait([this, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) {
+      if (alive.expired() || ec || !is_open()) return;
+      do_sample_tcp_info();
+    });
+  }
+
+  /**
+   * move socket to the executor of migrate_state, and resume read and write there
+   * @param resume the read continuation, nullptr if read paused
+   */
+  void finish_migrate(std::function<void()> resume) {
+    if (!is_migrating()) return;
+    migrate_->running = false;
+    auto handle = std::move(migrate_->handle);
+    auto executor = std::move(migrate_->executor);
+    auto moved = std::move(migrate_->moved);
+    if (!is_open()) {
+      if (handle) handle(false);
+      return;
+    }
+
+    // timers are bound to current executor, recreate lazily
+    bool sample_tcp_info = info_timer_ != nullptr;
+    read_timer_ = nullptr;
+    write_timer_ = nullptr;
+    info_timer_ = nullptr;
+    close_timer_ = nullptr;
+
+#ifndef _WIN32
+    asio::error_code ec;
+    auto protocol = get_socket().local_endpoint(ec).protocol();
+    if (!ec) {
+      auto fd = get_socket().release(ec);
+      if (!ec) {
+        typename decltype(protocol)::socket socket(executor);
+        socket.assign(protocol, fd, ec);
+        if (ec) ::close(fd);
+        get_socket() = std::move(socket);
+      }
+    }
+    if (ec || !is_open()) {
+      ASIO_NET_LOGE("migrate: %s", ec.message().c_str());
+      if (is_open()) {
+        do_close();
+      } else {
+        reset_data();
+        if (on_close) on_close();
+      }
+      if (handle) handle(false);
+      return;
+    }
+    if (is_lazy_read()) get_socket().non_blocking(true, ec);
+#endif
+    if (migrate_->hook) migrate_->hook();
+    // may run on new executor from now on
+    if (moved) moved();
+
+    asio::post(executor, [this, resume = std::move(resume), handle = std::move(handle), sample_tcp_info,
+                          alive = std::weak_ptr<void>(this->is_alive_)] {
+      if (alive.expired()) return;
+      if (sample_tcp_info) do_sample_tcp_info();
+      // messages queued while migrating
+      if (send_buffer_now_ != 0) do_write_next();
+      if (resume) resume();
+      if (handle) handle(true);
+    });
+  }
+
   void do_close() {
+    // may hold the last reference of this, release after return
+    auto read_resume = std::move(read_resume_);
     reset_data();
 
     if (!is_open()) return;
@@ -222,10 +807,16 @@ class tcp_channel_t : private noncopyable {
   }
 
   void reset_data() {
+    if (read_timer_) read_timer_->cancel();
+    if (write_timer_) write_timer_->cancel();
+    if (info_timer_) info_timer_->cancel();
+    if (close_timer_) close_timer_->cancel();
+    flush_closing_ = false;
     read_msg_.clear();
+    read_paused_by_backlog_ = false;
+    read_resume_ = nullptr;
     send_buffer_now_ = 0;
-    write_msg_queue_.clear();
-    write_msg_queue_.shrink_to_fit();
+    write_msg_queue_ = nullptr;
   }
 
  public:
@@ -239,8 +830,23 @@ class tcp_channel_t : private noncopyable {
   typename socket_impl<T>::socket& socket_;
   const tcp_config& config_;
   detail::message read_msg_;
+  bool read_paused_ = false;
+  bool read_paused_by_backlog_ = false;
+  bool read_pending_ = false;  // async read waiting on socket
+  std::function<void()> read_resume_;
+  uint32_t read_budget_messages_ = 0;
+  size_t read_budget_bytes_ = 0;
   size_t send_buffer_now_ = 0;
-  std::deque<std::string> write_msg_queue_;
+  bool flush_closing_ = false;
+  std::unique_ptr<std::deque<write_msg>> write_msg_queue_;  // lazy, std::deque allocates even if empty
+  tcp_stats stats_;
+  std::unique_ptr<token_bucket> send_bucket_;
+  std::unique_ptr<token_bucket> recv_bucket_;
+  std::unique_ptr<asio::steady_timer> read_timer_;
+  std::unique_ptr<asio::steady_timer> write_timer_;
+  std::unique_ptr<asio::steady_timer> info_timer_;
+  std::unique_ptr<asio::steady_timer> close_timer_;
+  std::unique_ptr<migrate_state> migrate_;
 };
 
 }  // namespace detail
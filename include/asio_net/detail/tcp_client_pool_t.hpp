@@ -0,0 +1,84 @@
+#pragma once
+
+#include <utility>
+
+#include "client_pool_t.hpp"
+#include "tcp_client_t.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * tcp_client_t connections to the same server used as one, for producers which one tcp stream can not carry
+ */
+template <socket_type T>
+class tcp_client_pool_t : public client_pool_t<T, tcp_client_t<T>> {
+ public:
+  /**
+   * @param executor io_context or any executor, connections share one strand if it is concurrent
+   */
+  explicit tcp_client_pool_t(io_executor executor, client_pool_config pool_config = {}, tcp_config tcp_config = {})
+      : client_pool_t<T, tcp_client_t<T>>(std::move(executor), pool_config) {
+    for (uint32_t i = 0; i < std::max(pool_config.pool_size, 1u); ++i) {
+      this->clients_.emplace_back(std::make_unique<tcp_client_t<T>>(this->executor_, tcp_config));
+    }
+    init();
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  explicit tcp_client_pool_t(io_executor executor, asio::ssl::context& ssl_context, client_pool_config pool_config = {}, tcp_config tcp_config = {})
+      : client_pool_t<T, tcp_client_t<T>>(std::move(executor), pool_config) {
+    for (uint32_t i = 0; i < std::max(pool_config.pool_size, 1u); ++i) {
+      this->clients_.emplace_back(std::make_unique<tcp_client_t<T>>(this->executor_, ssl_context, tcp_config));
+    }
+    init();
+  }
+#endif
+
+  /**
+   * send by the least loaded connection, no order between messages
+   * @return false if no connection open
+   */
+  bool send(std::string msg) {
+    auto index = this->select();
+    if (index == this->npos) return false;
+    this->clients_[index]->send(std::move(msg));
+    return true;
+  }
+
+  /**
+   * messages of the same key are sent in order by one connection, @see client_pool_t::select(size_t)
+   * @return false if no connection open
+   */
+  bool send_by_key(size_t key, std::string msg) {
+    auto index = this->select(key);
+    if (index == this->npos) return false;
+    this->clients_[index]->send(std::move(msg));
+    return true;
+  }
+
+ private:
+  void init() {
+    for (size_t i = 0; i < this->clients_.size(); ++i) {
+      auto& client = this->clients_[i];
+      client->on_open = [this, i] {
+        this->set_open(i, true);
+      };
+      client->on_open_failed = [this](std::error_code ec) {
+        if (this->on_open_failed) this->on_open_failed(ec);
+      };
+      client->on_close = [this, i] {
+        this->set_open(i, false);
+      };
+      client->on_data = [this](std::string data) {
+        if (on_data) on_data(std::move(data));
+      };
+    }
+  }
+
+ public:
+  std::function<void(std::string)> on_data;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "busy_poll.hpp"
+#include "dns_cache.hpp"
 #include "noncopyable.hpp"
 #include "tcp_channel_t.hpp"
 
@@ -8,15 +15,47 @@ namespace detail {
 
 template <socket_type T>
 class tcp_client_t : public tcp_channel_t<T> {
+  // one open of resolved endpoints, attempts may run in parallel by happy_eyeballs_delay_ms
+  struct connect_state {
+    explicit connect_state(const asio::any_io_executor& executor) : timer(executor) {}
+    std::string key;  // of dns_cache, empty if not cached
+    std::vector<asio::ip::tcp::endpoint> endpoints;
+    size_t next = 0;
+    size_t running = 0;
+    bool done = false;
+    std::error_code error;
+    std::vector<std::shared_ptr<asio::ip::tcp::socket>> sockets;
+    asio::steady_timer timer;
+  };
+
+  // message sent while disconnected, @see tcp_config::offline_queue_messages
+  struct offline_msg {
+    std::string body;
+    std::shared_ptr<const std::string> shared_body;
+    std::chrono::steady_clock::time_point deadline;
+
+    size_t size() const {
+      return shared_body ? shared_body->size() : body.size();
+    }
+  };
+
  public:
-  explicit tcp_client_t(asio::io_context& io_context, tcp_config config = {})
-      : tcp_channel_t<T>(socket_, config_), io_context_(io_context), socket_(io_context), config_(config) {
+  /**
+   * @param executor io_context, or any executor e.g. strand of asio::thread_pool
+   * @param config
+   */
+  explicit tcp_client_t(io_executor executor, tcp_config config = {})
+      : tcp_channel_t<T>(socket_, config_), executor_(std::move(executor)), socket_(executor_.get()), config_(config) {
     config_.init();
   }
 
 #ifdef ASIO_NET_ENABLE_SSL
-  explicit tcp_client_t(asio::io_context& io_context, asio::ssl::context& ssl_context, tcp_config config = {})
-      : tcp_channel_t<T>(socket_, config_), io_context_(io_context), socket_(io_context, ssl_context), config_(config) {
+  explicit tcp_client_t(io_executor executor, asio::ssl::context& ssl_context, tcp_config config = {})
+      : tcp_channel_t<T>(socket_, config_),
+        executor_(std::move(executor)),
+        socket_(executor_.get(), ssl_context),
+        config_(config),
+        ssl_context_(&ssl_context) {
     config_.init();
   }
 #endif
@@ -50,12 +89,19 @@ class tcp_client_t : public tcp_channel_t<T> {
     if (!need_reconnect) {
       cancel_reconnect();
     }
+    if (cancel_connect() && need_reconnect) check_reconnect();
     tcp_channel_t<T>::close();
   }
 
+  /**
+   * reconnect after closed or open failed
+   * interval grows by tcp_config::reconnect_max_ms and reconnect_jitter_percent if set
+   *
+   * @param ms interval, or the first one of backoff
+   */
   void set_reconnect(uint32_t ms) {
     reconnect_ms_ = ms;
-    reconnect_timer_ = std::make_unique<asio::steady_timer>(io_context_);
+    reconnect_timer_ = std::make_unique<asio::steady_timer>(executor_.get());
   }
 
   void cancel_reconnect() {
@@ -67,7 +113,7 @@ class tcp_client_t : public tcp_channel_t<T> {
 
   void check_reconnect() {
     if (!is_open && reconnect_timer_) {
-      reconnect_timer_->expires_after(std::chrono::milliseconds(reconnect_ms_));
+      reconnect_timer_->expires_after(std::chrono::milliseconds(next_reconnect_ms()));
       reconnect_timer_->async_wait([this](const asio::error_code& ec) {
         if (is_open) return;
         if (!ec) {
@@ -78,31 +124,105 @@ class tcp_client_t : public tcp_channel_t<T> {
     }
   }
 
+  /**
+   * async send message, @see tcp_channel_t::send
+   * while disconnected, queued by tcp_config::offline_queue_messages and sent in order once reconnected
+   *
+   * @return false if discarded by tcp_config::offline_queue_policy
+   */
+  bool send(std::string msg) {
+    return send(std::move(msg), std::chrono::steady_clock::time_point::max());
+  }
+
+  bool send(std::shared_ptr<const std::string> msg) {
+    if (!is_offline()) {
+      tcp_channel_t<T>::send(std::move(msg));
+      return true;
+    }
+    return enqueue_offline({{}, std::move(msg), std::chrono::steady_clock::time_point::max()});
+  }
+
+  /**
+   * deadline also applies to queued message, expired ones are dropped when reconnected
+   */
+  bool send(std::string msg, std::chrono::steady_clock::time_point deadline) {
+    if (!is_offline()) {
+      tcp_channel_t<T>::send(std::move(msg), deadline);
+      return true;
+    }
+    return enqueue_offline({std::move(msg), nullptr, deadline});
+  }
+
+  bool send(std::string msg, std::chrono::milliseconds expire) {
+    return send(std::move(msg), std::chrono::steady_clock::now() + expire);
+  }
+
+  /**
+   * messages queued while disconnected
+   */
+  size_t offline_queue_size() const {
+    return offline_queue_ ? offline_queue_->size() : 0;
+  }
+
+  /**
+   * messages dropped by offline queue full, not counted for offline_policy::reject
+   */
+  uint64_t offline_dropped() const {
+    return offline_dropped_;
+  }
+
+  /**
+   * run io_context until stop, not available for other executors
+   */
   void run() {
-    auto work = asio::make_work_guard(io_context_);
-    io_context_.run();
+    auto io_context = executor_.io_context();
+    if (!io_context) {
+      ASIO_NET_LOGE("run: needs io_context");
+      return;
+    }
+    auto work = asio::make_work_guard(*io_context);
+    io_context->run();
+  }
+
+  /**
+   * same as run, but spin on poll for low latency, @see detail::run_busy_poll
+   */
+  void run_busy_poll(busy_poll_config config = {}) {
+    auto io_context = executor_.io_context();
+    if (!io_context) {
+      ASIO_NET_LOGE("run_busy_poll: needs io_context");
+      return;
+    }
+    detail::run_busy_poll(*io_context, config);
   }
 
   void stop() {
     close();
-    io_context_.stop();
+    if (executor_.io_context()) executor_.io_context()->stop();
   }
 
  private:
   void do_open(const std::string& host, uint16_t port) {
     static_assert(T == socket_type::normal || T == socket_type::ssl, "");
-    auto resolver = std::make_unique<typename socket_impl<T>::resolver>(io_context_);
+    auto key = config_.dns_cache_ttl_ms ? dns_cache::make_key(host, port) : std::string();
+    std::vector<asio::ip::tcp::endpoint> cached;
+    if (!key.empty() && dns_cache::instance().get(key, std::chrono::milliseconds(config_.dns_cache_ttl_ms), cached)) {
+      do_connect(std::move(cached), std::move(key));
+      return;
+    }
+    auto resolver = std::make_unique<typename socket_impl<T>::resolver>(executor_.get());
     auto rp = resolver.get();
     rp->async_resolve(host, std::to_string(port),
-                      [this, resolver = std::move(resolver), alive = std::weak_ptr<void>(this->is_alive_)](
-                          const std::error_code& ec, const typename socket_impl<T>::resolver::results_type& endpoints) mutable {
+                      [this, resolver = std::move(resolver), key = std::move(key), alive = std::weak_ptr<void>(this->is_alive_)](
+                          const std::error_code& ec, const typename socket_impl<T>::resolver::results_type& results) mutable {
                         if (alive.expired()) return;
                         if (!ec) {
-                          asio::async_connect(tcp_channel_t<T>::get_socket(), endpoints,
-                                              [this, alive = std::move(alive)](const std::error_code& ec, const typename socket_impl<T>::endpoint&) {
-                                                if (alive.expired()) return;
-                                                async_connect_handler<T>(ec);
-                                              });
+                          std::vector<asio::ip::tcp::endpoint> endpoints;
+                          for (const auto& result : results) {
+                            endpoints.push_back(result.endpoint());
+                          }
+                          if (!key.empty()) dns_cache::instance().put(key, endpoints);
+                          do_connect(std::move(endpoints), std::move(key));
                         } else {
                           tcp_channel_t<T>::close_socket();  // release resource
                           if (on_open_failed) on_open_failed(ec);
@@ -111,6 +231,196 @@ class tcp_client_t : public tcp_channel_t<T> {
                       });
   }
 
+  /**
+   * connect endpoints in order, the next one starts when previous failed, or not done in happy_eyeballs_delay_ms
+   * first connected wins, others are closed
+   */
+  void do_connect(std::vector<asio::ip::tcp::endpoint> endpoints, std::string key) {
+    auto state = std::make_shared<connect_state>(executor_.get());
+    state->key = std::move(key);
+    state->endpoints = std::move(endpoints);
+    if (config_.happy_eyeballs_delay_ms != UINT32_MAX) interleave_family(state->endpoints);
+    connecting_ = state;
+    if (state->endpoints.empty()) {
+      on_connect(state, nullptr, asio::error_code(asio::error::host_not_found));
+      return;
+    }
+    connect_next(state);
+  }
+
+  void connect_next(const std::shared_ptr<connect_state>& state) {
+    auto& endpoint = state->endpoints[state->next++];
+    auto socket = std::make_shared<asio::ip::tcp::socket>(executor_.get());
+    // connect completes at once with TCP_FASTOPEN_CONNECT, an unreachable endpoint would win over the others
+    if (config_.socket_fastopen_connect && state->endpoints.size() == 1) {
+      asio::error_code ec;
+      socket->open(endpoint.protocol(), ec);
+      if (!ec) apply_connect_options(*socket, config_);
+    }
+    state->sockets.push_back(socket);
+    state->running += 1;
+    socket->async_connect(endpoint, [this, state, socket, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) {
+      if (alive.expired()) return;
+      on_connect(state, socket, ec);
+    });
+
+    if (state->next < state->endpoints.size() && config_.happy_eyeballs_delay_ms != UINT32_MAX) {
+      state->timer.expires_after(std::chrono::milliseconds(config_.happy_eyeballs_delay_ms));
+      state->timer.async_wait([this, state, alive = std::weak_ptr<void>(this->is_alive_)](const std::error_code& ec) {
+        if (alive.expired() || ec || state->done || state->next >= state->endpoints.size()) return;
+        connect_next(state);
+      });
+    }
+  }
+
+  void on_connect(const std::shared_ptr<connect_state>& state, const std::shared_ptr<asio::ip::tcp::socket>& socket, const std::error_code& ec) {
+    if (socket) state->running -= 1;
+    if (state->done) return;
+    if (!ec) {
+      tcp_channel_t<T>::get_socket() = std::move(*socket);
+      finish_connect(state);
+      async_connect_handler<T>(ec);
+      return;
+    }
+    state->error = ec;
+    if (state->next < state->endpoints.size()) {
+      // failed fast, not wait for the delay
+      state->timer.cancel();
+      connect_next(state);
+      return;
+    }
+    if (state->running != 0) return;
+    finish_connect(state);
+    if (!state->key.empty()) dns_cache::instance().remove(state->key);
+    async_connect_handler<T>(state->error);
+  }
+
+  void finish_connect(const std::shared_ptr<connect_state>& state) {
+    state->done = true;
+    state->timer.cancel();
+    for (auto& socket : state->sockets) {
+      asio::error_code ec;
+      socket->close(ec);
+    }
+    if (connecting_ == state) connecting_ = nullptr;
+  }
+
+  /**
+   * @return true if an open is canceled
+   */
+  bool cancel_connect() {
+    if (!connecting_) return false;
+    finish_connect(connecting_);
+    return true;
+  }
+
+  /**
+   * alternate address families and keep the first family first, e.g. v6, v4, v6, v4
+   */
+  static void interleave_family(std::vector<asio::ip::tcp::endpoint>& endpoints) {
+    if (endpoints.empty()) return;
+    std::vector<asio::ip::tcp::endpoint> first;
+    std::vector<asio::ip::tcp::endpoint> second;
+    bool first_v6 = endpoints[0].address().is_v6();
+    for (auto& endpoint : endpoints) {
+      (endpoint.address().is_v6() == first_v6 ? first : second).push_back(endpoint);
+    }
+    endpoints.clear();
+    for (size_t i = 0; i < std::max(first.size(), second.size()); ++i) {
+      if (i < first.size()) endpoints.push_back(first[i]);
+      if (i < second.size()) endpoints.push_back(second[i]);
+    }
+  }
+
+  /**
+   * reconnect_ms doubled by each failure up to reconnect_max_ms, then randomized by reconnect_jitter_percent
+   */
+  uint32_t next_reconnect_ms() {
+    uint64_t ms = reconnect_ms_;
+    if (config_.reconnect_max_ms > reconnect_ms_) {
+      ms = std::min<uint64_t>(ms << std::min(reconnect_failures_, 20u), config_.reconnect_max_ms);
+    }
+    if (reconnect_failures_ < UINT32_MAX) reconnect_failures_ += 1;
+    uint64_t span = ms * std::min(config_.reconnect_jitter_percent, 100u) / 100;
+    if (span != 0) {
+      static thread_local std::minstd_rand gen(std::random_device{}());
+      ms = ms - span + std::uniform_int_distribution<uint64_t>(0, span * 2)(gen);
+    }
+    return (uint32_t)std::min<uint64_t>(ms, UINT32_MAX);
+  }
+
+  bool is_offline() const {
+    return !is_open && config_.offline_queue_messages != 0;
+  }
+
+  bool enqueue_offline(offline_msg msg) {
+    auto size = msg.size();
+    if (!offline_queue_) offline_queue_ = std::make_unique<std::deque<offline_msg>>();
+    auto full = [&] {
+      return offline_queue_->size() >= config_.offline_queue_messages || offline_queue_bytes_ + size > config_.offline_queue_bytes;
+    };
+    if (full() && (config_.offline_queue_policy != offline_policy::drop_oldest || size > config_.offline_queue_bytes)) {
+      if (config_.offline_queue_policy != offline_policy::reject) offline_dropped_ += 1;
+      return false;
+    }
+    while (full()) {
+      offline_queue_bytes_ -= offline_queue_->front().size();
+      offline_queue_->pop_front();
+      offline_dropped_ += 1;
+    }
+    offline_queue_bytes_ += size;
+    offline_queue_->push_back(std::move(msg));
+    return true;
+  }
+
+  /**
+   * send messages queued while disconnected, before on_open
+   * queued again if closed meanwhile, e.g. when send blocks on max_send_buffer_size
+   */
+  void flush_offline() {
+    if (!offline_queue_) return;
+    auto queue = std::move(offline_queue_);
+    offline_queue_bytes_ = 0;
+    for (auto& msg : *queue) {
+      if (msg.shared_body) {
+        send(std::move(msg.shared_body));
+      } else {
+        send(std::move(msg.body), msg.deadline);
+      }
+    }
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  /**
+   * ssl state of last connection can not be reused, rebuild stream over the connected socket
+   * and offer the saved session for resumption, @see tcp_config::ssl_session_resumption
+   */
+  void init_ssl_stream() {
+    using ssl_stream = typename socket_impl<socket_type::ssl>::socket;
+    ssl_stream stream(std::move(socket_.next_layer()), *ssl_context_);
+    // closed without close_notify, openssl would mark the saved session not resumable when freed
+    SSL_set_shutdown(socket_.native_handle(), SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    socket_ = std::move(stream);
+    if (ssl_session_) SSL_set_session(socket_.native_handle(), ssl_session_.get());
+  }
+
+  /**
+   * keep session for next connection, tickets of tls 1.3 arrive after handshake so also called on close
+   */
+  void save_ssl_session() {
+    if (!config_.ssl_session_resumption) return;
+    auto session = SSL_get1_session(socket_.native_handle());
+    if (!session) return;
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if (!SSL_SESSION_is_resumable(session)) {
+      SSL_SESSION_free(session);
+      return;
+    }
+#endif
+    ssl_session_.reset(session, SSL_SESSION_free);
+  }
+#endif
+
   void do_open(const std::string& endpoint) {
     static_assert(T == socket_type::domain, "");
     socket_.async_connect(typename socket_impl<T>::endpoint(endpoint), [this](const std::error_code& ec) {
@@ -130,12 +440,21 @@ class tcp_client_t : public tcp_channel_t<T> {
   bool is_open = false;
 
  private:
-  asio::io_context& io_context_;
+  io_executor executor_;
   typename socket_impl<T>::socket socket_;
   tcp_config config_;
   std::unique_ptr<asio::steady_timer> reconnect_timer_;
   uint32_t reconnect_ms_ = 0;
+  uint32_t reconnect_failures_ = 0;
+  std::shared_ptr<connect_state> connecting_;
   std::function<void()> open_;
+  std::unique_ptr<std::deque<offline_msg>> offline_queue_;  // lazy, std::deque allocates even if empty
+  size_t offline_queue_bytes_ = 0;
+  uint64_t offline_dropped_ = 0;
+#ifdef ASIO_NET_ENABLE_SSL
+  asio::ssl::context* ssl_context_ = nullptr;
+  std::shared_ptr<SSL_SESSION> ssl_session_;  // of last connection, offered on reconnect
+#endif
 };
 
 template <>
@@ -149,6 +468,8 @@ inline void tcp_client_t<socket_type::normal>::async_connect_handler<socket_type
       check_reconnect();
     };
     is_open = true;
+    reconnect_failures_ = 0;
+    flush_offline();
     if (on_open) on_open();
     if (reconnect_timer_) {
       reconnect_timer_->cancel();
@@ -171,6 +492,8 @@ inline void tcp_client_t<socket_type::domain>::async_connect_handler<socket_type
       check_reconnect();
     };
     is_open = true;
+    reconnect_failures_ = 0;
+    flush_offline();
     if (on_open) on_open();
     if (reconnect_timer_) {
       reconnect_timer_->cancel();
@@ -187,15 +510,20 @@ template <>
 template <>
 inline void tcp_client_t<socket_type::ssl>::async_connect_handler<socket_type::ssl>(const std::error_code& ec) {
   if (!ec) {
+    init_ssl_stream();
     this->init_socket();
     socket_.async_handshake(asio::ssl::stream_base::client, [this](const std::error_code& error) {
       if (!error) {
+        save_ssl_session();
         tcp_channel_t<socket_type::ssl>::on_close = [this] {
+          save_ssl_session();
           is_open = false;
           if (tcp_client_t::on_close) tcp_client_t::on_close();
           check_reconnect();
         };
         is_open = true;
+        reconnect_failures_ = 0;
+        flush_offline();
         if (on_open) on_open();
         if (reconnect_timer_) {
           reconnect_timer_->cancel();
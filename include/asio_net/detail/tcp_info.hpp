@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "asio.hpp"
+
+namespace asio_net {
+
+/**
+ * snapshot of kernel tcp metrics, fields not supported by platform are 0
+ */
+struct tcp_metrics {
+  bool valid = false;          // false: not tcp socket, or platform not supported
+  bool syn_data = false;       // data sent on SYN was acked, tcp fastopen, linux only
+  uint32_t rtt_us = 0;         // smoothed rtt
+  uint32_t rttvar_us = 0;      // rtt variance
+  uint32_t snd_cwnd = 0;       // congestion window, segments
+  uint32_t snd_mss = 0;        // bytes per segment
+  uint32_t retransmits = 0;    // consecutive retransmit timeouts now
+  uint32_t total_retrans = 0;  // retransmitted segments in total
+  uint64_t bytes_acked = 0;    // bytes acked by peer
+  uint32_t notsent_bytes = 0;  // bytes in send buffer not sent yet
+};
+
+namespace detail {
+
+#ifdef __linux__
+/**
+ * layout of struct tcp_info in <linux/tcp.h>, which conflicts with <netinet/tcp.h>
+ * glibc version is truncated at tcpi_total_retrans, newer fields are read by returned length
+ */
+struct linux_tcp_info {
+  uint8_t tcpi_state;
+  uint8_t tcpi_ca_state;
+  uint8_t tcpi_retransmits;
+  uint8_t tcpi_probes;
+  uint8_t tcpi_backoff;
+  uint8_t tcpi_options;
+  uint8_t tcpi_wscale;
+  uint8_t tcpi_flags;
+
+  uint32_t tcpi_rto;
+  uint32_t tcpi_ato;
+  uint32_t tcpi_snd_mss;
+  uint32_t tcpi_rcv_mss;
+
+  uint32_t tcpi_unacked;
+  uint32_t tcpi_sacked;
+  uint32_t tcpi_lost;
+  uint32_t tcpi_retrans;
+  uint32_t tcpi_fackets;
+
+  uint32_t tcpi_last_data_sent;
+  uint32_t tcpi_last_ack_sent;
+  uint32_t tcpi_last_data_recv;
+  uint32_t tcpi_last_ack_recv;
+
+  uint32_t tcpi_pmtu;
+  uint32_t tcpi_rcv_ssthresh;
+  uint32_t tcpi_rtt;
+  uint32_t tcpi_rttvar;
+  uint32_t tcpi_snd_ssthresh;
+  uint32_t tcpi_snd_cwnd;
+  uint32_t tcpi_advmss;
+  uint32_t tcpi_reordering;
+
+  uint32_t tcpi_rcv_rtt;
+  uint32_t tcpi_rcv_space;
+
+  uint32_t tcpi_total_retrans;
+
+  uint64_t tcpi_pacing_rate;
+  uint64_t tcpi_max_pacing_rate;
+  uint64_t tcpi_bytes_acked;
+  uint64_t tcpi_bytes_received;
+  uint32_t tcpi_segs_out;
+  uint32_t tcpi_segs_in;
+
+  uint32_t tcpi_notsent_bytes;
+};
+#endif
+
+/**
+ * not tcp socket, e.g. domain socket
+ */
+template <typename Socket>
+inline tcp_metrics get_tcp_metrics(Socket& /*socket*/) {
+  return {};
+}
+
+/**
+ * read kernel tcp metrics by getsockopt, linux and macos only
+ */
+template <typename Executor>
+inline tcp_metrics get_tcp_metrics(asio::basic_socket<asio::ip::tcp, Executor>& socket) {
+  tcp_metrics metrics;
+  if (!socket.is_open()) return metrics;
+#if defined(__linux__)
+  linux_tcp_info info{};
+  socklen_t len = sizeof(info);
+  if (::getsockopt(socket.native_handle(), IPPROTO_TCP, TCP_INFO, &info, &len) != 0) return metrics;
+  auto has = [len](size_t end) {
+    return len >= end;
+  };
+  if (!has(offsetof(linux_tcp_info, tcpi_pacing_rate))) return metrics;
+  metrics.valid = true;
+  metrics.rtt_us = info.tcpi_rtt;
+  metrics.rttvar_us = info.tcpi_rttvar;
+  metrics.snd_cwnd = info.tcpi_snd_cwnd;
+  metrics.snd_mss = info.tcpi_snd_mss;
+  metrics.retransmits = info.tcpi_retransmits;
+  metrics.total_retrans = info.tcpi_total_retrans;
+#ifdef TCPI_OPT_SYN_DATA
+  metrics.syn_data = info.tcpi_options & TCPI_OPT_SYN_DATA;
+#endif
+  // since linux 4.1 and 4.6
+  if (has(offsetof(linux_tcp_info, tcpi_bytes_received))) metrics.bytes_acked = info.tcpi_bytes_acked;
+  if (has(offsetof(linux_tcp_info, tcpi_notsent_bytes) + sizeof(info.tcpi_notsent_bytes))) metrics.notsent_bytes = info.tcpi_notsent_bytes;
+#elif defined(__APPLE__) && defined(TCP_CONNECTION_INFO)
+  tcp_connection_info info{};
+  socklen_t len = sizeof(info);
+  if (::getsockopt(socket.native_handle(), IPPROTO_TCP, TCP_CONNECTION_INFO, &info, &len) != 0) return metrics;
+  metrics.valid = true;
+  metrics.rtt_us = info.tcpi_srtt * 1000;
+  metrics.rttvar_us = info.tcpi_rttvar * 1000;
+  metrics.snd_mss = info.tcpi_maxseg;
+  metrics.snd_cwnd = info.tcpi_maxseg ? info.tcpi_snd_cwnd / info.tcpi_maxseg : 0;
+  metrics.total_retrans = (uint32_t)info.tcpi_txretransmitpackets;
+  metrics.notsent_bytes = info.tcpi_snd_sbbytes;
+#endif
+  return metrics;
+}
+
+}  // namespace detail
+}  // namespace asio_net
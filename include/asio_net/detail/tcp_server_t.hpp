@@ -1,79 +1,348 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "../config.hpp"
+#include "accept_limiter.hpp"
 #include "asio.hpp"
+#include "block_pool.hpp"
+#include "io_context_pool.hpp"
+#include "io_executor.hpp"
+#include "listen_fd.hpp"
+#include "session_registry.hpp"
+#include "socket_option.hpp"
 #include "tcp_channel_t.hpp"
 
 namespace asio_net {
 namespace detail {
 
+template <socket_type T>
+class tcp_server_t;
+
 template <socket_type T>
 class tcp_session_t : public tcp_channel_t<T>, public std::enable_shared_from_this<tcp_session_t<T>> {
   using socket = typename socket_impl<T>::socket;
 
  public:
-  explicit tcp_session_t(socket socket, const tcp_config& config) : tcp_channel_t<T>(socket_, config), socket_(std::move(socket)) {
+  /**
+   * @param load_token released with session, @see io_context_pool::acquire
+   */
+  explicit tcp_session_t(socket socket, const tcp_config& config, std::shared_ptr<void> load_token = nullptr)
+      : tcp_channel_t<T>(socket_, config),
+        socket_(std::move(socket)),
+        io_context_(io_executor(socket_.get_executor()).io_context()),
+        load_token_(std::move(load_token)) {
     this->init_socket();
   }
 
+  ~tcp_session_t() {
+    auto registry = registry_.lock();
+    if (registry) registry->remove(this);
+  }
+
   void start() {
     tcp_channel_t<T>::do_read_start(tcp_session_t<T>::shared_from_this());
   }
 
 #ifdef ASIO_NET_ENABLE_SSL
-  void async_handshake(std::function<void(std::error_code)> handle) {
-    socket_.async_handshake(asio::ssl::stream_base::server, [this, handle = std::move(handle)](const std::error_code& error) {
+  /**
+   * @param handshake_context crypto of handshake runs on it if set, socket stays on executor of session
+   * handle is called on executor of session either way
+   */
+  void async_handshake(std::function<void(std::error_code)> handle, asio::io_context* handshake_context = nullptr) {
+    auto on_handshake = [this, handle = std::move(handle)](const std::error_code& error) {
       handle(error);
       if (!error) {
         this->start();
       }
-    });
+    };
+    if (!handshake_context) {
+      socket_.async_handshake(asio::ssl::stream_base::server, std::move(on_handshake));
+      return;
+    }
+    // each step of handshake is invoked on executor bound to the handler, only the completion is posted back
+    socket_.async_handshake(asio::ssl::stream_base::server,
+                            asio::bind_executor(*handshake_context, [this, on_handshake = std::move(on_handshake)](const std::error_code& error) {
+                              asio::post(socket_.get_executor(), [on_handshake = std::move(on_handshake), error] {
+                                on_handshake(error);
+                              });
+                            }));
   }
 #endif
 
  private:
+  friend class tcp_server_t<T>;
   socket socket_;
+  std::atomic<asio::io_context*> io_context_;  // updated on migrate, read by other threads
+  std::shared_ptr<void> load_token_;
+  std::weak_ptr<session_registry<tcp_session_t>> registry_;
+  std::shared_ptr<void> ip_token_;
 };
 
 template <socket_type T>
 class tcp_server_t {
   using socket = typename socket_impl<T>::socket;
   using endpoint = typename socket_impl<T>::endpoint;
+  using acceptor = typename socket_impl<T>::acceptor;
+  static constexpr size_t no_shard = SIZE_MAX;
 
  public:
-  tcp_server_t(asio::io_context& io_context, uint16_t port, tcp_config config = {})
-      : io_context_(io_context),
-        acceptor_(io_context, endpoint(config.enable_ipv6 ? asio::ip::tcp::v6() : asio::ip::tcp::v4(), port)),
+  /**
+   * @param executor io_context, or any executor e.g. asio::thread_pool, which sessions run on with a strand per session
+   * @param port
+   * @param config
+   */
+  tcp_server_t(io_executor executor, uint16_t port, tcp_config config = {})
+      : executor_(std::move(executor)),
+        acceptor_(
+            open_acceptor(acceptor_executor(executor_), endpoint(config.enable_ipv6 ? asio::ip::tcp::v6() : asio::ip::tcp::v4(), port), config)),
         config_(config) {
-    config_.init();
+    init();
   }
 
 #ifdef ASIO_NET_ENABLE_SSL
-  tcp_server_t(asio::io_context& io_context, uint16_t port, asio::ssl::context& ssl_context, tcp_config config = {})
-      : io_context_(io_context), ssl_context_(ssl_context), acceptor_(io_context, endpoint(asio::ip::tcp::v4(), port)), config_(config) {
-    config_.init();
+  tcp_server_t(io_executor executor, uint16_t port, asio::ssl::context& ssl_context, tcp_config config = {})
+      : executor_(std::move(executor)),
+        ssl_context_(ssl_context),
+        acceptor_(open_acceptor(acceptor_executor(executor_), endpoint(asio::ip::tcp::v4(), port), config)),
+        config_(config) {
+    init();
+    init_ssl_resumption();
   }
 #endif
 
   /**
    * domain socket
    *
-   * @param io_context
+   * @param executor
    * @param endpoint e.g. /tmp/foobar
    * @param config
    */
-  tcp_server_t(asio::io_context& io_context, const std::string& endpoint, tcp_config config = {})
-      : io_context_(io_context), acceptor_(io_context, typename socket_impl<T>::endpoint(endpoint)), config_(config) {
-    config_.init();
+  tcp_server_t(io_executor executor, const std::string& endpoint, tcp_config config = {})
+      : executor_(std::move(executor)),
+        acceptor_(open_acceptor(acceptor_executor(executor_), typename socket_impl<T>::endpoint(endpoint), config)),
+        config_(config) {
+    init();
+  }
+
+#ifndef _WIN32
+  /**
+   * adopt a pre-opened listening socket, @see listen_fd
+   * NOTICE: listen options of config are not applied, e.g. backlog, reuse_port
+   */
+  tcp_server_t(io_executor executor, listen_fd fd, tcp_config config = {})
+      : executor_(std::move(executor)), acceptor_(adopt_acceptor(acceptor_executor(executor_), fd)), config_(config) {
+    static_assert(T != detail::socket_type::ssl, "");
+    init();
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  tcp_server_t(io_executor executor, listen_fd fd, asio::ssl::context& ssl_context, tcp_config config = {})
+      : executor_(std::move(executor)), ssl_context_(ssl_context), acceptor_(adopt_acceptor(acceptor_executor(executor_), fd)), config_(config) {
+    static_assert(T == detail::socket_type::ssl, "");
+    init();
+    init_ssl_resumption();
+  }
+#endif
+#endif
+
+  ~tcp_server_t() {
+    // close shard acceptors on their own threads
+    for (auto& shard : shard_acceptors_) {
+      auto executor = shard->get_executor();
+      asio::post(executor, [shard = std::move(shard)] {
+        asio::error_code ec;
+        shard->close(ec);
+      });
+    }
   }
 
  public:
   void start(bool loop = false) {
-    do_accept<T>();
+    if (!accept_limiter_ && T != socket_type::domain && (config_.max_connections_per_ip != UINT32_MAX || config_.accept_rate_per_ip)) {
+      accept_limiter_ = std::make_shared<accept_limiter>(config_.max_connections_per_ip, config_.accept_rate_per_ip, config_.accept_burst_per_ip);
+    }
+    if (handshake_pool_) handshake_pool_->start();
+    if (io_context_pool_) {
+      io_context_pool_->start();
+      start_shards();
+      start_rebalance();
+    }
+    for (uint32_t i = 0; i < std::max(config_.accept_pending, 1u); ++i) {
+      do_accept<T>(acceptor_, no_shard);
+    }
     if (loop) {
-      io_context_.run();
+      if (executor_.io_context()) {
+        executor_.io_context()->run();
+      } else {
+        ASIO_NET_LOGE("start: loop needs io_context");
+      }
+    }
+  }
+
+  /**
+   * run sessions on a pool of io_contexts, acceptor still run on executor of server
+   * NOTICE:
+   * 1. should be called before start
+   * 2. session callbacks, including @see`on_session`, will be called on pool threads
+   * 3. pool will be started by start, and destroyed with server if not shared
+   * 4. with tcp_config.reuse_port, each pool thread owns an acceptor on the same port, kernel spreads accepts across them
+   */
+  void set_io_context_pool(std::shared_ptr<io_context_pool> pool) {
+    io_context_pool_ = std::move(pool);
+  }
+
+  /**
+   * ssl only, run handshakes on a pool instead of the io thread of session, then hand session back to it
+   * keeps established sessions responsive in reconnect storms, the asymmetric crypto of full handshakes is cpu heavy
+   * NOTICE: should be called before start, pool will be started by start
+   */
+  void set_handshake_pool(std::shared_ptr<io_context_pool> pool) {
+    static_assert(T == socket_type::ssl, "");
+    handshake_pool_ = std::move(pool);
+  }
+
+  /**
+   * listening socket, e.g. hand off to new process by send_listen_fd
+   */
+  typename acceptor::native_handle_type native_handle() {
+    return acceptor_.native_handle();
+  }
+
+  /**
+   * graceful shutdown for restart: stop accepting, flush queued messages of sessions and close them
+   * threadsafe, should be called after listening socket handed off to new process
+   * sessions accepted but not registered yet, or ssl sessions in handshake, are closed once registered
+   *
+   * @param timeout sessions will be closed after timeout even if messages not sent, @see session_count
+   */
+  void drain(std::chrono::milliseconds timeout) {
+    // sessions registered from now on close themselves, e.g. accepted before acceptors closed, or in handshake
+    drain_timeout_ms_ = timeout.count();
+    draining_ = true;
+    // snapshot after all acceptors closed on their executors
+    auto pending = std::make_shared<std::atomic<size_t>>(1 + shard_acceptors_.size());
+    auto closed = [this, pending, timeout] {
+      if (--*pending != 0) return;
+      for (auto& session : registry_->snapshot()) {
+        auto executor = session->get_executor();
+        asio::dispatch(executor, [session = std::move(session), timeout] {
+          session->flush_and_close(timeout);
+        });
+      }
+    };
+    auto alive = std::weak_ptr<void>(is_alive_);
+    asio::post(acceptor_.get_executor(), [this, closed, alive] {
+      if (alive.expired()) return;
+      asio::error_code ec;
+      acceptor_.close(ec);
+      closed();
+    });
+    for (auto& shard : shard_acceptors_) {
+      asio::post(shard->get_executor(), [shard = shard.get(), closed, alive] {
+        if (alive.expired()) return;
+        asio::error_code ec;
+        shard->close(ec);
+        closed();
+      });
+    }
+  }
+
+  /**
+   * move session to io_context of pool, e.g. long-lived heavy sessions piled up on one thread
+   * threadsafe, @see tcp_channel_t::migrate, tcp_config::rebalance_interval_ms
+   *
+   * @param session
+   * @param index of io_context_pool
+   * @param handle called with true on new io_context when done, with false if not quiescent or not supported
+   */
+  void migrate(const std::shared_ptr<tcp_session_t<T>>& session, size_t index, std::function<void(bool)> handle = nullptr) {
+    if (!io_context_pool_ || index >= io_context_pool_->size()) {
+      if (handle) handle(false);
+      return;
+    }
+    auto current = session->io_context_.load();
+    if (!current) {
+      if (handle) handle(false);
+      return;
+    }
+    asio::dispatch(*current, [this, session, index, current, handle = std::move(handle), alive = std::weak_ptr<void>(is_alive_)]() mutable {
+      if (alive.expired()) return;
+      // moved away before dispatched
+      if (session->io_context_ != current) {
+        migrate(session, index, std::move(handle));
+        return;
+      }
+      auto& context = io_context_pool_->get_io_context(index);
+      if (current == &context) {
+        if (handle) handle(true);
+        return;
+      }
+      // load moves with session
+      auto load_token = io_context_pool_->acquire(index);
+      auto done = [session, load_token, handle](bool ok) mutable {
+        if (ok) session->load_token_ = std::move(load_token);
+        if (handle) handle(ok);
+      };
+      auto moved = [session, &context] {
+        session->io_context_ = &context;
+      };
+      if (!session->migrate(context, done, moved)) done(false);
+    });
+  }
+
+  /**
+   * connections rejected by max_connections_per_ip or accept_rate_per_ip
+   */
+  uint64_t rejected_count() const {
+    return rejected_count_;
+  }
+
+  /**
+   * alive sessions, ssl sessions are counted from accept, including those in handshake
+   * NOTICE: session is counted until destroyed, closed sessions still held by user keep counting
+   */
+  size_t session_count() const {
+    return registry_->size();
+  }
+
+  /**
+   * snapshot of alive sessions, ssl sessions after handshake
+   * NOTICE: session should be used on its own executor if io_context_pool set or executor is concurrent
+   */
+  std::vector<std::shared_ptr<tcp_session_t<T>>> sessions() const {
+    return registry_->snapshot();
+  }
+
+  /**
+   * send message to all open sessions, the buffer is shared by sessions without copy
+   * threadsafe, sessions are sent on their own executor, one dispatch per io_context, one per session if executor is concurrent
+   *
+   * @param msg can be string or binary
+   */
+  void broadcast(std::string msg) {
+    auto shared_msg = std::make_shared<const std::string>(std::move(msg));
+    std::unordered_map<asio::io_context*, std::vector<std::shared_ptr<tcp_session_t<T>>>> groups;
+    for (auto& session : registry_->snapshot()) {
+      auto context = session->io_context_.load();
+      if (context) {
+        groups[context].push_back(std::move(session));
+        continue;
+      }
+      // session of concurrent executor has its own strand
+      auto executor = session->get_executor();
+      asio::dispatch(executor, [session = std::move(session), shared_msg] {
+        if (session->is_open()) session->send(shared_msg);
+      });
+    }
+    for (auto& group : groups) {
+      send_on(*group.first, std::move(group.second), shared_msg);
     }
   }
 
@@ -85,44 +354,445 @@ class tcp_server_t {
 #endif
 
  private:
+  void init() {
+    config_.init();
+    if (config_.session_pool_size) session_pools_ = std::make_unique<block_pool_map>(config_.session_pool_size);
+  }
+
+#ifdef ASIO_NET_ENABLE_SSL
+  /**
+   * session cache for session id, and tickets which need no server state, @see tcp_config::ssl_session_resumption
+   * NOTICE: set on ssl context, shared by all servers of it
+   */
+  void init_ssl_resumption() {
+    if (!config_.ssl_session_resumption) return;
+    static const unsigned char session_id_context[] = "asio_net";
+    auto ctx = ssl_context_.native_handle();
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_session_id_context(ctx, session_id_context, sizeof(session_id_context) - 1);
+    SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+  }
+#endif
+
   template <socket_type>
-  void do_accept();
+  void do_accept(acceptor& acceptor, size_t shard);
+
+  /**
+   * open acceptor with listen options of config, e.g. SO_REUSEPORT, TCP_FASTOPEN, backlog
+   */
+  static acceptor open_acceptor(const asio::any_io_executor& executor, const endpoint& endpoint, const tcp_config& config) {
+    acceptor acceptor(executor);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(asio::socket_base::reuse_address(true));
+    if (T != socket_type::domain) {
+      if (config.reuse_port) {
+#ifdef SO_REUSEPORT
+        set_socket_option(acceptor, SOL_SOCKET, SO_REUSEPORT, 1u, "SO_REUSEPORT");
+#else
+        ASIO_NET_LOGW("SO_REUSEPORT not supported");
+#endif
+      }
+#ifdef TCP_DEFER_ACCEPT
+      set_socket_option(acceptor, IPPROTO_TCP, TCP_DEFER_ACCEPT, config.socket_defer_accept_s, "TCP_DEFER_ACCEPT");
+#endif
+#ifdef TCP_FASTOPEN
+      set_socket_option(acceptor, IPPROTO_TCP, TCP_FASTOPEN, config.socket_fastopen, "TCP_FASTOPEN");
+#endif
+    }
+    acceptor.bind(endpoint);
+    acceptor.listen(config.accept_backlog != UINT32_MAX ? (int)config.accept_backlog : asio::socket_base::max_listen_connections);
+    return acceptor;
+  }
+
+  /**
+   * one acceptor per pool io_context on the same port, accepted socket stay on the thread
+   * main acceptor is still in the reuseport group, and dispatch sessions to pool
+   */
+  void start_shards() {
+    if (!config_.reuse_port || T == socket_type::domain || !shard_acceptors_.empty()) return;
+    auto endpoint = acceptor_.local_endpoint();
+    for (size_t i = 0; i < io_context_pool_->size(); ++i) {
+      auto shard = std::make_unique<acceptor>(open_acceptor(io_context_pool_->get_io_context(i).get_executor(), endpoint, config_));
+#ifdef SO_INCOMING_CPU
+      // prefer the acceptor on the cpu which handled the SYN
+      int cpu = io_context_pool_->cpu(i);
+      if (cpu >= 0) set_socket_option(*shard, SOL_SOCKET, SO_INCOMING_CPU, (uint32_t)cpu, "SO_INCOMING_CPU");
+#endif
+      shard_acceptors_.push_back(std::move(shard));
+    }
+    for (size_t i = 0; i < shard_acceptors_.size(); ++i) {
+      asio::post(io_context_pool_->get_io_context(i), [this, shard = shard_acceptors_[i].get(), i, alive = std::weak_ptr<void>(is_alive_)] {
+        if (alive.expired()) return;
+        for (uint32_t n = 0; n < std::max(config_.accept_pending, 1u); ++n) {
+          do_accept<T>(*shard, i);
+        }
+      });
+    }
+  }
+
+#ifndef _WIN32
+  /**
+   * take the ownership of fd, closed if failed
+   */
+  static acceptor adopt_acceptor(const asio::any_io_executor& executor, listen_fd fd) {
+    endpoint local;
+    socklen_t len = (socklen_t)local.capacity();
+    if (::getsockname(fd.fd, local.data(), &len) != 0) {
+      int err = errno;
+      ::close(fd.fd);
+      throw std::system_error(err, std::system_category(), "adopt listen_fd");
+    }
+    local.resize(len);
+    acceptor acceptor(executor);
+    asio::error_code ec;
+    acceptor.assign(local.protocol(), fd.fd, ec);
+    if (ec) {
+      ::close(fd.fd);
+      throw std::system_error(ec, "adopt listen_fd");
+    }
+    return acceptor;
+  }
+#endif
+
+  /**
+   * stop accepting when sessions reach max_connections, new connections wait in kernel backlog
+   * @return true if paused, will be resumed after a session removed
+   */
+  bool throttle_accept(acceptor& acceptor, size_t shard) {
+    if (config_.max_connections == UINT32_MAX) return false;
+    // resumed on thread of the removed session, server may be gone
+    bool paused = registry_->pause_if_full(config_.max_connections, [this, &acceptor, shard, alive = std::weak_ptr<void>(is_alive_)] {
+      if (alive.expired()) return;
+      asio::post(acceptor.get_executor(), [this, &acceptor, shard, alive] {
+        if (alive.expired()) return;
+        do_accept<T>(acceptor, shard);
+      });
+    });
+    if (paused) {
+      ASIO_NET_LOGD("accept paused: max_connections=%u", config_.max_connections);
+    }
+    return paused;
+  }
+
+  /**
+   * admission control by source ip, @see tcp_config::max_connections_per_ip
+   * @return false if rejected and socket closed, otherwise ip_token should be hold by session
+   */
+  bool admit_peer(asio::ip::tcp::socket& peer, std::shared_ptr<void>& ip_token) {
+    if (!accept_limiter_) return true;
+    asio::error_code ec;
+    auto remote = peer.remote_endpoint(ec);
+    if (!ec) ip_token = accept_limiter_->admit(remote.address());
+    if (ip_token) return true;
+    ASIO_NET_LOGD("accept rejected: %s", ec ? ec.message().c_str() : remote.address().to_string().c_str());
+    ++rejected_count_;
+    peer.close(ec);
+    return false;
+  }
+
+  /**
+   * retry accept after error, avoid acceptor stop forever
+   * transient errors like EMFILE will be retried with backoff, from accept_retry_min_ms to accept_retry_max_ms
+   */
+  void retry_accept(acceptor& acceptor, size_t shard, const std::error_code& ec) {
+    if (ec == asio::error::operation_aborted || !acceptor.is_open()) return;
+    // peer reset before accepted, not a server problem
+    if (ec == asio::error::connection_aborted) {
+      do_accept<T>(acceptor, shard);
+      return;
+    }
+    uint32_t backoff = std::min(std::max(accept_backoff_ms_ * 2, config_.accept_retry_min_ms), config_.accept_retry_max_ms);
+    accept_backoff_ms_ = backoff;
+    ASIO_NET_LOGW("accept: %s, retry after %ums", ec.message().c_str(), backoff);
+    auto timer = std::make_shared<asio::steady_timer>(acceptor.get_executor());
+    timer->expires_after(std::chrono::milliseconds(backoff));
+    timer->async_wait([this, timer, &acceptor, shard, alive = std::weak_ptr<void>(is_alive_)](const std::error_code& ec) {
+      if (alive.expired() || ec) return;
+      do_accept<T>(acceptor, shard);
+    });
+  }
+
+  /**
+   * accept handlers of one acceptor are serialized, by a strand if executor is concurrent
+   */
+  static asio::any_io_executor acceptor_executor(const io_executor& executor) {
+    return executor.make_strand().get();
+  }
+
+  /**
+   * select executor for next session, shard acceptor use its own io_context
+   * a new strand per session if executor is concurrent
+   * @param index of io_context_pool, @see acquire_load
+   */
+  io_executor next_executor(size_t shard, size_t& index) {
+    if (!io_context_pool_) return executor_.make_strand();
+    index = shard != no_shard ? shard : io_context_pool_->select();
+    return io_context_pool_->get_io_context(index);
+  }
+
+  /**
+   * send to sessions on io_context, sessions moved away after grouped are sent on their new io_context
+   */
+  static void send_on(asio::io_context& context, std::vector<std::shared_ptr<tcp_session_t<T>>> sessions,
+                      std::shared_ptr<const std::string> msg) {
+    asio::dispatch(context, [&context, sessions = std::move(sessions), msg] {
+      for (auto& session : sessions) {
+        auto current = session->io_context_.load();
+        if (current != &context) {
+          if (current) send_on(*current, {session}, msg);
+          continue;
+        }
+        if (session->is_open()) session->send(msg);
+      }
+    });
+  }
+
+  /**
+   * count accepted session as load of pool io_context, pending accepts are not counted
+   */
+  std::shared_ptr<void> acquire_load(size_t index) {
+    return io_context_pool_ ? io_context_pool_->acquire(index) : nullptr;
+  }
+
+  /**
+   * accept socket onto executor, by io_context if possible, accept by any_io_executor costs an allocation per socket
+   */
+  template <typename Handler>
+  static void async_accept(acceptor& acceptor, const io_executor& executor, Handler&& handler) {
+    if (executor.is_concurrent()) {
+      acceptor.async_accept(executor.get(), std::forward<Handler>(handler));
+    } else {
+      acceptor.async_accept(*executor.io_context(), std::forward<Handler>(handler));
+    }
+  }
+
+  /**
+   * sample traffic of sessions on each pool io_context periodically, @see tcp_config::rebalance_interval_ms
+   */
+  void start_rebalance() {
+    if (!config_.rebalance_interval_ms || rebalance_timer_) return;
+    rebalance_timer_ = std::make_unique<asio::steady_timer>(acceptor_.get_executor());
+    do_rebalance();
+  }
+
+  void do_rebalance() {
+    rebalance_timer_->expires_after(std::chrono::milliseconds(config_.rebalance_interval_ms));
+    rebalance_timer_->async_wait([this, alive = std::weak_ptr<void>(is_alive_)](const std::error_code& ec) {
+      if (alive.expired() || ec) return;
+      sample_traffic();
+    });
+  }
+
+  struct traffic_sample {
+    std::shared_ptr<tcp_session_t<T>> session;
+    size_t index;
+    uint64_t bytes;
+  };
+
+  /**
+   * read stats of sessions on their own io_context, then rebalance on acceptor executor
+   */
+  void sample_traffic() {
+    struct collector {
+      std::mutex mutex;
+      std::vector<traffic_sample> samples;
+      size_t pending;
+    };
+    std::vector<asio::io_context*> contexts;
+    for (size_t i = 0; i < io_context_pool_->size(); ++i) {
+      contexts.push_back(&io_context_pool_->get_io_context(i));
+    }
+    std::vector<std::vector<std::shared_ptr<tcp_session_t<T>>>> groups(contexts.size());
+    for (auto& session : registry_->snapshot()) {
+      auto it = std::find(contexts.begin(), contexts.end(), session->io_context_.load());
+      if (it != contexts.end()) groups[it - contexts.begin()].push_back(std::move(session));
+    }
+    auto result = std::make_shared<collector>();
+    result->pending = groups.size();
+    auto executor = acceptor_.get_executor();
+    auto alive = std::weak_ptr<void>(is_alive_);
+    for (size_t i = 0; i < groups.size(); ++i) {
+      asio::post(*contexts[i], [this, i, context = contexts[i], group = std::move(groups[i]), result, executor, alive] {
+        std::lock_guard<std::mutex> lock(result->mutex);
+        for (auto& session : group) {
+          // moved away after grouped
+          if (session->io_context_ != context) continue;
+          const auto& stats = session->stats();
+          result->samples.push_back({session, i, stats.send_bytes + stats.recv_bytes});
+        }
+        if (--result->pending != 0) return;
+        asio::post(executor, [this, result, alive] {
+          if (alive.expired()) return;
+          rebalance(std::move(result->samples));
+          do_rebalance();
+        });
+      });
+    }
+  }
+
+  /**
+   * move one session from the busiest thread to the idlest, which narrows the traffic gap most without reversing it
+   */
+  void rebalance(std::vector<traffic_sample> samples) {
+    std::vector<uint64_t> load(io_context_pool_->size());
+    std::unordered_map<const void*, uint64_t> last_bytes;
+    for (auto& sample : samples) {
+      auto key = sample.session.get();
+      auto it = rebalance_bytes_.find(key);
+      // memory of closed session may be reused by new one
+      uint64_t delta = it != rebalance_bytes_.end() && it->second <= sample.bytes ? sample.bytes - it->second : sample.bytes;
+      last_bytes[key] = sample.bytes;
+      sample.bytes = delta;
+      load[sample.index] += delta;
+    }
+    rebalance_bytes_ = std::move(last_bytes);
+
+    auto busiest = (size_t)(std::max_element(load.begin(), load.end()) - load.begin());
+    auto idlest = (size_t)(std::min_element(load.begin(), load.end()) - load.begin());
+    uint64_t gap = load[busiest] - load[idlest];
+    if (gap < config_.rebalance_min_bytes) return;
+    std::vector<std::shared_ptr<tcp_session_t<T>>> candidates;
+    std::sort(samples.begin(), samples.end(), [](const traffic_sample& a, const traffic_sample& b) {
+      return a.bytes > b.bytes;
+    });
+    for (auto& sample : samples) {
+      if (sample.index == busiest && sample.bytes > 0 && sample.bytes <= gap / 2) candidates.push_back(std::move(sample.session));
+    }
+    ASIO_NET_LOGD("rebalance: busiest=%zu idlest=%zu gap=%llu candidates=%zu", busiest, idlest, (unsigned long long)gap, candidates.size());
+    migrate_any(std::move(candidates), 0, idlest);
+  }
+
+  /**
+   * try candidates in order until one is quiescent and moved
+   */
+  void migrate_any(std::vector<std::shared_ptr<tcp_session_t<T>>> candidates, size_t next, size_t index) {
+    if (next >= candidates.size()) return;
+    auto session = candidates[next];
+    migrate(session, index, [this, candidates = std::move(candidates), next, index, alive = std::weak_ptr<void>(is_alive_)](bool ok) mutable {
+      if (alive.expired() || ok) return;
+      migrate_any(std::move(candidates), next + 1, index);
+    });
+  }
+
+  /**
+   * block_pool of execution context which session runs on, nullptr if session_pool_size not set
+   */
+  std::shared_ptr<block_pool> session_pool(asio::execution_context& context) {
+    return session_pools_ ? session_pools_->get(&context) : nullptr;
+  }
+
+  /**
+   * close session registered after drain started, on executor of session
+   * @return true if closed, session should not be started
+   */
+  bool close_if_draining(const std::shared_ptr<tcp_session_t<T>>& session) {
+    if (!draining_) return false;
+    session->flush_and_close(std::chrono::milliseconds(drain_timeout_ms_.load()));
+    return true;
+  }
+
+  /**
+   * create session on executor of the socket, inline if already on it
+   * socket is closed if server destroyed before dispatched, pool may outlive server
+   */
+  template <typename Socket, typename Handle>
+  void dispatch_session(Socket socket, std::shared_ptr<void> load_token, Handle handle) {
+    if (!io_context_pool_ && !executor_.is_concurrent()) {
+      handle(std::move(socket), std::move(load_token));
+      return;
+    }
+    auto executor = socket.get_executor();
+    asio::dispatch(executor, [socket = std::move(socket), load_token = std::move(load_token), handle = std::move(handle),
+                              alive = std::weak_ptr<void>(is_alive_)]() mutable {
+      if (alive.expired()) return;
+      handle(std::move(socket), std::move(load_token));
+    });
+  }
 
  private:
-  asio::io_context& io_context_;
+  io_executor executor_;
 #ifdef ASIO_NET_ENABLE_SSL
   typename std::conditional<T == socket_type::ssl, asio::ssl::context&, uint8_t>::type ssl_context_;
 #endif
-  typename socket_impl<T>::acceptor acceptor_;
+  acceptor acceptor_;
   tcp_config config_;
+  std::shared_ptr<session_registry<tcp_session_t<T>>> registry_ = std::make_shared<session_registry<tcp_session_t<T>>>();
+  std::vector<std::unique_ptr<acceptor>> shard_acceptors_;
+  std::atomic<uint32_t> accept_backoff_ms_{0};
+  std::shared_ptr<accept_limiter> accept_limiter_;
+  std::unique_ptr<block_pool_map> session_pools_;
+  std::atomic<uint64_t> rejected_count_{0};
+  std::atomic_bool draining_{false};
+  std::atomic<std::chrono::milliseconds::rep> drain_timeout_ms_{0};
+  std::unique_ptr<asio::steady_timer> rebalance_timer_;
+  std::unordered_map<const void*, uint64_t> rebalance_bytes_;  // traffic of last sample, on acceptor executor
+  std::shared_ptr<void> is_alive_ = std::make_shared<uint8_t>();
+  // destroy first, stop threads which may use this
+  std::shared_ptr<io_context_pool> io_context_pool_;
+  std::shared_ptr<io_context_pool> handshake_pool_;
 };
 
 template <>
 template <>
-inline void tcp_server_t<socket_type::normal>::do_accept<socket_type::normal>() {
-  acceptor_.async_accept([this](const std::error_code& ec, socket socket) {
+inline void tcp_server_t<socket_type::normal>::do_accept<socket_type::normal>(acceptor& acceptor, size_t shard) {
+  if (throttle_accept(acceptor, shard)) return;
+  size_t index = 0;
+  auto executor = next_executor(shard, index);
+  // completion of shard acceptor may be queued on pool thread when server destroyed
+  async_accept(acceptor, executor, [this, &acceptor, index, alive = std::weak_ptr<void>(is_alive_)](const std::error_code& ec, socket peer) mutable {
+    if (alive.expired()) return;
+    // index of shard acceptor is its shard
+    auto shard = &acceptor == &acceptor_ ? no_shard : index;
     if (!ec) {
-      auto session = std::make_shared<tcp_session_t<socket_type::normal>>(std::move(socket), config_);
-      session->start();
-      if (on_session) on_session(session);
-      tcp_server_t<socket_type::normal>::do_accept<socket_type::normal>();
+      accept_backoff_ms_ = 0;
+      std::shared_ptr<void> ip_token;
+      if (!admit_peer(peer, ip_token)) {
+        tcp_server_t<socket_type::normal>::do_accept<socket_type::normal>(acceptor, shard);
+        return;
+      }
+      auto handle = [this, ip_token = std::move(ip_token)](socket socket, std::shared_ptr<void> load_token) mutable {
+        auto pool = session_pool(socket.get_executor().context());
+        auto session = make_shared_pooled<tcp_session_t<socket_type::normal>>(pool, std::move(socket), config_, std::move(load_token));
+        session->ip_token_ = std::move(ip_token);
+        session->registry_ = registry_;
+        registry_->add(session);
+        if (close_if_draining(session)) return;
+        session->start();
+        if (on_session) on_session(session);
+      };
+      dispatch_session(std::move(peer), acquire_load(index), std::move(handle));
+      tcp_server_t<socket_type::normal>::do_accept<socket_type::normal>(acceptor, shard);
     } else {
       ASIO_NET_LOGD("do_accept: %s", ec.message().c_str());
+      retry_accept(acceptor, shard, ec);
     }
   });
 }
 
 template <>
 template <>
-inline void tcp_server_t<socket_type::domain>::do_accept<socket_type::domain>() {
-  acceptor_.async_accept([this](const std::error_code& ec, socket socket) {
+inline void tcp_server_t<socket_type::domain>::do_accept<socket_type::domain>(acceptor& acceptor, size_t shard) {
+  if (throttle_accept(acceptor, shard)) return;
+  size_t index = 0;
+  auto executor = next_executor(shard, index);
+  async_accept(acceptor, executor, [this, &acceptor, index, alive = std::weak_ptr<void>(is_alive_)](const std::error_code& ec, socket peer) mutable {
+    if (alive.expired()) return;
+    auto shard = &acceptor == &acceptor_ ? no_shard : index;
     if (!ec) {
-      auto session = std::make_shared<tcp_session_t<socket_type::domain>>(std::move(socket), config_);
-      session->start();
-      if (on_session) on_session(session);
-      tcp_server_t<socket_type::domain>::do_accept<socket_type::domain>();
+      accept_backoff_ms_ = 0;
+      dispatch_session(std::move(peer), acquire_load(index), [this](socket socket, std::shared_ptr<void> load_token) {
+        auto pool = session_pool(socket.get_executor().context());
+        auto session = make_shared_pooled<tcp_session_t<socket_type::domain>>(pool, std::move(socket), config_, std::move(load_token));
+        session->registry_ = registry_;
+        registry_->add(session);
+        if (close_if_draining(session)) return;
+        session->start();
+        if (on_session) on_session(session);
+      });
+      tcp_server_t<socket_type::domain>::do_accept<socket_type::domain>(acceptor, shard);
     } else {
       ASIO_NET_LOGD("do_accept: %s", ec.message().c_str());
+      retry_accept(acceptor, shard, ec);
     }
   });
 }
@@ -130,21 +800,59 @@ inline void tcp_server_t<socket_type::domain>::do_accept<socket_type::domain>()
 #ifdef ASIO_NET_ENABLE_SSL
 template <>
 template <>
-inline void tcp_server_t<socket_type::ssl>::do_accept<socket_type::ssl>() {
-  acceptor_.async_accept([this](const std::error_code& ec, asio::ip::tcp::socket socket) {
+inline void tcp_server_t<socket_type::ssl>::do_accept<socket_type::ssl>(acceptor& acceptor, size_t shard) {
+  if (throttle_accept(acceptor, shard)) return;
+  size_t index = 0;
+  auto executor = next_executor(shard, index);
+  async_accept(acceptor, executor, [this, &acceptor, index, alive = std::weak_ptr<void>(is_alive_)](const std::error_code& ec,
+                                                                                                    asio::ip::tcp::socket peer) mutable {
+    if (alive.expired()) return;
+    auto shard = &acceptor == &acceptor_ ? no_shard : index;
     if (!ec) {
-      using ssl_stream = typename socket_impl<socket_type::ssl>::socket;
-      auto session = std::make_shared<tcp_session_t<socket_type::ssl>>(ssl_stream(std::move(socket), ssl_context_), config_);
-      session->async_handshake([this, session](const std::error_code& error) {
-        if (!error) {
-          if (on_session) on_session(session);
-        } else {
-          if (on_handshake_error) on_handshake_error(error);
+      accept_backoff_ms_ = 0;
+      std::shared_ptr<void> ip_token;
+      if (!admit_peer(peer, ip_token)) {
+        do_accept<socket_type::ssl>(acceptor, shard);
+        return;
+      }
+      auto handle = [this, ip_token = std::move(ip_token)](asio::ip::tcp::socket socket, std::shared_ptr<void> load_token) mutable {
+        using ssl_stream = typename socket_impl<socket_type::ssl>::socket;
+        auto pool = session_pool(socket.get_executor().context());
+        auto session =
+            make_shared_pooled<tcp_session_t<socket_type::ssl>>(pool, ssl_stream(std::move(socket), ssl_context_), config_, std::move(load_token));
+        session->ip_token_ = std::move(ip_token);
+        // counted by max_connections in handshake, not exposed by sessions until established
+        session->registry_ = registry_;
+        registry_->add(session, false);
+        // handshake counted as load of pool thread until done
+        asio::io_context* handshake_context = nullptr;
+        std::shared_ptr<void> handshake_token;
+        if (handshake_pool_) {
+          auto index = handshake_pool_->select();
+          handshake_context = &handshake_pool_->get_io_context(index);
+          handshake_token = handshake_pool_->acquire(index);
         }
-      });
-      do_accept<socket_type::ssl>();
+        session->async_handshake(
+            [this, session, handshake_token = std::move(handshake_token), alive = std::weak_ptr<void>(is_alive_)](const std::error_code& error) {
+              if (alive.expired()) return;
+              if (!error) {
+                registry_->establish(session.get());
+                if (close_if_draining(session)) return;
+                if (on_session) on_session(session);
+              } else {
+                // release the slot now, session may be destroyed later
+                registry_->remove(session.get());
+                session->registry_.reset();
+                if (on_handshake_error) on_handshake_error(error);
+              }
+            },
+            handshake_context);
+      };
+      dispatch_session(std::move(peer), acquire_load(index), std::move(handle));
+      do_accept<socket_type::ssl>(acceptor, shard);
     } else {
       ASIO_NET_LOGD("do_accept: %s", ec.message().c_str());
+      retry_accept(acceptor, shard, ec);
     }
   });
 }
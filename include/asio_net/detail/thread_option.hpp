@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "asio.hpp"
+#include "log.h"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * parse cpu or node list of linux sysfs, e.g. "0-3,8,10-11"
+ */
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    auto end = list.find(',', pos);
+    if (end == std::string::npos) end = list.size();
+    auto range = list.substr(pos, end - pos);
+    auto dash = range.find('-');
+    if (!range.empty() && range[0] >= '0' && range[0] <= '9') {
+      int first = std::atoi(range.c_str());
+      int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+/**
+ * cpus of numa node, linux only
+ * @return empty if node not exist or not supported
+ */
+inline std::vector<int> numa_node_cpus(int node) {
+#ifdef __linux__
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  std::string list;
+  if (file && std::getline(file, list)) return parse_cpu_list(list);
+#else
+  (void)node;
+#endif
+  return {};
+}
+
+/**
+ * online numa nodes of system, ids may be sparse, and a node may have memory only without cpu
+ * @return {0} if not supported
+ */
+inline std::vector<int> numa_nodes() {
+#ifdef __linux__
+  std::ifstream file("/sys/devices/system/node/online");
+  std::string list;
+  if (file && std::getline(file, list)) {
+    auto nodes = parse_cpu_list(list);
+    if (!nodes.empty()) return nodes;
+  }
+#endif
+  return {0};
+}
+
+/**
+ * online numa nodes of system, at least 1, @see numa_nodes
+ */
+inline int numa_node_count() {
+  return (int)numa_nodes().size();
+}
+
+/**
+ * pin current thread to cpus, linux only
+ * @return false if failed or not supported
+ */
+inline bool set_thread_affinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+  if (cpus.empty()) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (ret != 0) {
+    ASIO_NET_LOGW("set_thread_affinity: %d", ret);
+    return false;
+  }
+  return true;
+#else
+  (void)cpus;
+  ASIO_NET_LOGW("set_thread_affinity: not supported");
+  return false;
+#endif
+}
+
+/**
+ * run current thread in real-time scheduling class, SCHED_FIFO on posix
+ * NOTICE: need CAP_SYS_NICE or RLIMIT_RTPRIO on linux, a busy thread can starve the whole cpu
+ * @param priority 1~99 on linux, mapped to THREAD_PRIORITY_TIME_CRITICAL on windows
+ * @return false if failed
+ */
+inline bool set_thread_realtime(int priority) {
+#ifdef _WIN32
+  (void)priority;
+  if (!::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+    ASIO_NET_LOGW("set_thread_realtime: %lu", ::GetLastError());
+    return false;
+  }
+  return true;
+#else
+  sched_param param{};
+  param.sched_priority = priority;
+  int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (ret != 0) {
+    ASIO_NET_LOGW("set_thread_realtime: %d", ret);
+    return false;
+  }
+  return true;
+#endif
+}
+
+}  // namespace detail
+}  // namespace asio_net
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "noncopyable.hpp"
+
+namespace asio_net {
+namespace detail {
+
+/**
+ * token bucket for bandwidth shaping
+ * tokens are bytes, consume may go into debt, so a message larger than burst can still pass
+ * threadsafe, can be shared by channels on different threads
+ */
+class token_bucket : private noncopyable {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  /**
+   * @param rate bytes per second
+   * @param burst bucket size, 0: same as rate
+   */
+  explicit token_bucket(uint64_t rate, uint64_t burst = 0)
+      : rate_(rate), burst_(burst ? burst : rate), tokens_((double)burst_), last_(clock::now()) {}
+
+  void consume(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill();
+    tokens_ -= (double)bytes;
+  }
+
+  /**
+   * @return time need to wait until tokens available, zero if available now
+   */
+  clock::duration wait_time() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill();
+    if (tokens_ >= 0) return clock::duration::zero();
+    auto wait = std::chrono::duration<double>(-tokens_ / (double)rate_);
+    return std::max<clock::duration>(std::chrono::duration_cast<clock::duration>(wait), std::chrono::milliseconds(1));
+  }
+
+  uint64_t rate() const {
+    return rate_;
+  }
+
+ private:
+  void refill() {
+    auto now = clock::now();
+    auto elapsed = std::chrono::duration<double>(now - last_).count();
+    last_ = now;
+    tokens_ = std::min((double)burst_, tokens_ + elapsed * (double)rate_);
+  }
+
+ private:
+  const uint64_t rate_;
+  const uint64_t burst_;
+  double tokens_;
+  clock::time_point last_;
+  std::mutex mutex_;
+};
+
+}  // namespace detail
+}  // namespace asio_net
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "asio.hpp"
+#include "io_executor.hpp"
 #include "noncopyable.hpp"
 
 namespace asio_net {
@@ -15,7 +16,7 @@ class udp_client_t : private noncopyable {
   using result_cb = std::function<void(const std::error_code&, std::size_t)>;
 
  public:
-  explicit udp_client_t(asio::io_context& io_context) : socket_(create_socket<T>(io_context)) {}
+  explicit udp_client_t(io_executor executor) : socket_(create_socket<T>(executor.get())) {}
 
   void send_to(std::string data, const endpoint& endpoint, result_cb cb = nullptr) {
     auto keeper = std::make_unique<std::string>(std::move(data));
@@ -55,14 +56,15 @@ class udp_client_t : private noncopyable {
 
  private:
   template <typename Type>
-  static typename std::enable_if<std::is_same<Type, asio::ip::udp>::value, typename Type::socket>::type create_socket(asio::io_context& io_context) {
-    return typename Type::socket(io_context, typename Type::endpoint());
+  static typename std::enable_if<std::is_same<Type, asio::ip::udp>::value, typename Type::socket>::type create_socket(
+      const asio::any_io_executor& executor) {
+    return typename Type::socket(executor, typename Type::endpoint());
   }
 
   template <typename Type>
   static typename std::enable_if<std::is_same<Type, asio::local::datagram_protocol>::value, typename Type::socket>::type create_socket(
-      asio::io_context& io_context) {
-    typename Type::socket s(io_context);
+      const asio::any_io_executor& executor) {
+    typename Type::socket s(executor);
     s.open();
     return s;
   }
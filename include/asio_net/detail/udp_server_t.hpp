@@ -1,6 +1,7 @@
 #pragma once
 
 #include "asio.hpp"
+#include "io_executor.hpp"
 #include "log.h"
 #include "noncopyable.hpp"
 
@@ -14,8 +15,8 @@ class udp_server_t : private noncopyable {
   using endpoint = typename T::endpoint;
 
  public:
-  udp_server_t(asio::io_context& io_context, short port, uint16_t max_length = 4096)
-      : io_context_(io_context), socket_(io_context, typename T::endpoint(T::v4(), port)), max_length_(max_length) {
+  udp_server_t(io_executor executor, short port, uint16_t max_length = 4096)
+      : executor_(std::move(executor)), socket_(executor_.get(), typename T::endpoint(T::v4(), port)), max_length_(max_length) {
     data_.resize(max_length);
     do_receive();
   }
@@ -23,18 +24,25 @@ class udp_server_t : private noncopyable {
   /**
    * domain socket
    *
-   * @param io_context
+   * @param executor
    * @param endpoint e.g. /tmp/foobar
    * @param max_length
    */
-  udp_server_t(asio::io_context& io_context, const std::string& endpoint, uint16_t max_length = 4096)
-      : io_context_(io_context), socket_(io_context, typename T::endpoint(endpoint)), max_length_(max_length) {
+  udp_server_t(io_executor executor, const std::string& endpoint, uint16_t max_length = 4096)
+      : executor_(std::move(executor)), socket_(executor_.get(), typename T::endpoint(endpoint)), max_length_(max_length) {
     data_.resize(max_length);
     do_receive();
   }
 
+  /**
+   * run io_context, not available for other executors
+   */
   void start() {
-    io_context_.run();
+    if (executor_.io_context()) {
+      executor_.io_context()->run();
+    } else {
+      ASIO_NET_LOGE("start: needs io_context");
+    }
   }
 
   std::function<void(uint8_t* data, size_t size, endpoint from)> on_data;
@@ -52,7 +60,7 @@ class udp_server_t : private noncopyable {
   }
 
  private:
-  asio::io_context& io_context_;
+  io_executor executor_;
   socket socket_;
   endpoint from_endpoint_;
   uint16_t max_length_;
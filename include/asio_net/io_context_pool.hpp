@@ -0,0 +1,15 @@
+#pragma once
+
+#include "detail/io_context_pool.hpp"
+
+namespace asio_net {
+
+using io_context_pool = detail::io_context_pool;
+using detail::numa_node_count;
+using detail::numa_node_cpus;
+using detail::numa_nodes;
+using detail::run_busy_poll;
+using detail::set_thread_affinity;
+using detail::set_thread_realtime;
+
+}  // namespace asio_net
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "detail/listen_fd.hpp"
+
+#ifndef _WIN32
+namespace asio_net {
+
+using listen_fd = detail::listen_fd;
+using detail::recv_listen_fd;
+using detail::send_listen_fd;
+using detail::systemd_listen_fds;
+
+}  // namespace asio_net
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "detail/loop_monitor.hpp"
+
+namespace asio_net {
+
+using loop_monitor = detail::loop_monitor;
+
+}  // namespace asio_net
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "asio.hpp"
+#include "detail/rpc_client_pool_t.hpp"
+
+namespace asio_net {
+
+using rpc_client_pool = detail::rpc_client_pool_t<detail::socket_type::normal>;
+using rpc_client_pool_ssl = detail::rpc_client_pool_t<detail::socket_type::ssl>;
+using domain_rpc_client_pool = detail::rpc_client_pool_t<detail::socket_type::domain>;
+
+}  // namespace asio_net
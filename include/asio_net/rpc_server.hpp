@@ -2,6 +2,8 @@
 
 #include "asio.hpp"
 #include "detail/rpc_server_t.hpp"
+#include "io_context_pool.hpp"
+#include "listen_fd.hpp"
 #include "rpc_session.hpp"
 
 namespace asio_net {
@@ -7,14 +7,19 @@
 #include "asio_net/detail/log.h"
 #include "asio_net/detail/message.hpp"
 #include "config.hpp"
+#include "detail/io_executor.hpp"
 #include "detail/noncopyable.hpp"
 
 namespace asio_net {
 
 class serial_port : detail::noncopyable {
  public:
-  explicit serial_port(asio::io_context& io_context, serial_config config = {})
-      : io_context_(io_context), serial_(io_context), config_(std::move(config)) {}
+  /**
+   * @param executor io_context, or any executor e.g. strand of asio::thread_pool
+   * @param config
+   */
+  explicit serial_port(detail::io_executor executor, serial_config config = {})
+      : executor_(std::move(executor)), serial_(executor_.get()), config_(std::move(config)) {}
 
   template <typename Option>
   inline void set_option(const Option& option) {
@@ -48,7 +53,7 @@ class serial_port : detail::noncopyable {
 
   void set_reconnect(uint32_t ms) {
     reconnect_ms_ = ms;
-    reconnect_timer_ = std::make_unique<asio::steady_timer>(io_context_);
+    reconnect_timer_ = std::make_unique<asio::steady_timer>(executor_.get());
   }
 
   void cancel_reconnect() {
@@ -62,9 +67,17 @@ class serial_port : detail::noncopyable {
     return config_;
   }
 
+  /**
+   * run io_context, not available for other executors
+   */
   void run() {
-    auto work = asio::make_work_guard(io_context_);
-    io_context_.run();
+    auto io_context = executor_.io_context();
+    if (!io_context) {
+      ASIO_NET_LOGE("run: needs io_context");
+      return;
+    }
+    auto work = asio::make_work_guard(*io_context);
+    io_context->run();
   }
 
  private:
@@ -87,10 +100,14 @@ class serial_port : detail::noncopyable {
       do_close();
     }
 
-    // block wait send_buffer idle
+    // block wait send_buffer idle, only a plain io_context can be run here
     while (msg.size() + send_buffer_now_ > config_.max_send_buffer_size) {
+      if (executor_.is_concurrent()) {
+        ASIO_NET_LOGD("write: send_buffer full, can not block on executor");
+        break;
+      }
       ASIO_NET_LOGV("block wait send_buffer idle");
-      io_context_.run_one();
+      executor_.io_context()->run_one();
     }
 
     // queue for asio::async_write
@@ -113,7 +130,7 @@ class serial_port : detail::noncopyable {
       }
 
       if (!write_msg_queue_.empty()) {
-        asio::post(io_context_, [this, msg = std::move(write_msg_queue_.front())]() mutable {
+        asio::post(executor_.get(), [this, msg = std::move(write_msg_queue_.front())]() mutable {
           do_write(std::move(msg), true);
         });
         write_msg_queue_.pop_front();
@@ -175,7 +192,7 @@ class serial_port : detail::noncopyable {
   std::function<void(std::string)> on_data;
 
  private:
-  asio::io_context& io_context_;
+  detail::io_executor executor_;
   asio::serial_port serial_;
   serial_config config_;
 
@@ -6,6 +6,7 @@
 #include <utility>
 
 #include "asio.hpp"
+#include "detail/io_executor.hpp"
 #include "detail/log.h"
 
 namespace asio_net {
@@ -24,9 +25,9 @@ class receiver {
   using service_found_handle_t = std::function<void(std::string name, std::string message)>;
 
  public:
-  receiver(asio::io_context& io_context, service_found_handle_t handle,  // NOLINT(cppcoreguidelines-pro-type-member-init)
+  receiver(detail::io_executor executor, service_found_handle_t handle,  // NOLINT(cppcoreguidelines-pro-type-member-init)
            std::string addr = addr_default, uint16_t port = port_default)
-      : socket_(io_context), service_found_handle_(std::move(handle)), addr_(std::move(addr)), port_(port) {
+      : socket_(executor.get()), service_found_handle_(std::move(handle)), addr_(std::move(addr)), port_(port) {
     try_init();
   }
 
@@ -89,11 +90,11 @@ class receiver {
 
 class sender {
  public:
-  sender(asio::io_context& io_context, const std::string& service_name, const std::string& message, uint32_t send_period_sec = 1,
+  sender(detail::io_executor executor, const std::string& service_name, const std::string& message, uint32_t send_period_sec = 1,
          const char* addr = addr_default, uint16_t port = port_default)
       : endpoint_(asio::ip::make_address(addr), port),
-        socket_(io_context, endpoint_.protocol()),
-        timer_(io_context),
+        socket_(executor.get(), endpoint_.protocol()),
+        timer_(executor.get()),
         send_period_sec_(send_period_sec),
         message_("discovery\n" + service_name + '\n' + message) {
     do_send();
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "asio.hpp"
+#include "detail/striped_client_t.hpp"
+
+namespace asio_net {
+
+using striped_client = detail::striped_client_t<detail::socket_type::normal>;
+using striped_client_ssl = detail::striped_client_t<detail::socket_type::ssl>;
+using domain_striped_client = detail::striped_client_t<detail::socket_type::domain>;
+
+}  // namespace asio_net
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "asio.hpp"
+#include "detail/striped_server_t.hpp"
+
+namespace asio_net {
+
+using striped_session = detail::striped_channel_t<detail::socket_type::normal>;
+using striped_session_ssl = detail::striped_channel_t<detail::socket_type::ssl>;
+using striped_server = detail::striped_server_t<detail::socket_type::normal>;
+using striped_server_ssl = detail::striped_server_t<detail::socket_type::ssl>;
+
+using domain_striped_session = detail::striped_channel_t<detail::socket_type::domain>;
+using domain_striped_server = detail::striped_server_t<detail::socket_type::domain>;
+
+}  // namespace asio_net
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "asio.hpp"
+#include "detail/tcp_client_pool_t.hpp"
+
+namespace asio_net {
+
+using tcp_client_pool = detail::tcp_client_pool_t<detail::socket_type::normal>;
+using tcp_client_pool_ssl = detail::tcp_client_pool_t<detail::socket_type::ssl>;
+using domain_tcp_client_pool = detail::tcp_client_pool_t<detail::socket_type::domain>;
+
+}  // namespace asio_net
@@ -2,6 +2,8 @@
 
 #include "asio.hpp"
 #include "detail/tcp_server_t.hpp"
+#include "io_context_pool.hpp"
+#include "listen_fd.hpp"
 
 namespace asio_net {
 
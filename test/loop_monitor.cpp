@@ -0,0 +1,69 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "asio_net/loop_monitor.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+int main() {
+  // histogram
+  {
+    loop_lag_stats stats;
+    ASSERT(stats.percentile(0.99) == 0);
+    stats.count = 100;
+    stats.max_us = 3000;
+    stats.buckets[4] = 98;   // [8, 16)
+    stats.buckets[12] = 2;   // [2048, 4096)
+    ASSERT(stats.percentile(0.5) == 16);
+    ASSERT(stats.percentile(0.98) == 16);
+    ASSERT(stats.percentile(0.99) == 3000);
+  }
+
+  asio::io_context context;
+  loop_monitor monitor(context, std::chrono::milliseconds(10), std::chrono::milliseconds(50));
+  uint32_t lag_num = 0;
+  monitor.on_lag = [&](std::chrono::microseconds lag) {
+    LOG("on_lag: %lldus", (long long)lag.count());
+    ASSERT(lag >= std::chrono::milliseconds(50));
+    ++lag_num;
+  };
+  monitor.start();
+
+  // idle loop, no lag reported
+  context.run_for(std::chrono::milliseconds(200));
+  auto stats = monitor.stats();
+  LOG("idle: count: %llu, p99: %lluus", (unsigned long long)stats.count, (unsigned long long)stats.percentile(0.99));
+  ASSERT(stats.count > 5);
+  ASSERT(lag_num == 0);
+
+  // handler blocks the loop, watchdog thread sees pending probe
+  monitor.reset_stats();
+  std::thread watchdog;
+  asio::post(context, [&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    watchdog = std::thread([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(60));
+      LOG("pending_lag: %lldus", (long long)monitor.pending_lag().count());
+      ASSERT(monitor.pending_lag() >= std::chrono::milliseconds(50));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  });
+  context.run_for(std::chrono::milliseconds(200));
+  watchdog.join();
+  stats = monitor.stats();
+  LOG("blocked: count: %llu, max: %lluus", (unsigned long long)stats.count, (unsigned long long)stats.max_us);
+  ASSERT(lag_num == 1);
+  ASSERT(stats.max_us >= 50 * 1000);
+  ASSERT(stats.percentile(1) == stats.max_us);
+
+  // stopped
+  monitor.stop();
+  monitor.reset_stats();
+  context.run_for(std::chrono::milliseconds(50));
+  ASSERT(monitor.stats().count == 0);
+  ASSERT(monitor.pending_lag() == std::chrono::microseconds::zero());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asio_net/io_context_pool.hpp"
+#include "asio_net/rpc_client.hpp"
+#include "asio_net/rpc_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const uint32_t PING_NUM = 20000;
+
+/**
+ * rpc ping-pong over loopback, one call in flight, server and client run in the same mode
+ * report round trip latency of blocking run() and busy poll with different spin budgets
+ * @param config nullptr: run()
+ */
+static void test_latency(const char* name, const busy_poll_config* config) {
+  asio::io_context server_context;
+  rpc_server server(server_context, PORT, rpc_config{.socket_nodelay = 1});
+  server.on_session = [](const std::weak_ptr<rpc_session>& rs) {
+    rs.lock()->rpc->subscribe("ping", [](const std::string& data) -> std::string {
+      return data;
+    });
+  };
+  server.start();
+  std::thread server_thread([&] {
+    if (config) {
+      // pin server and client to different cpus
+      busy_poll_config server_config = *config;
+      server_config.cpu = 1;
+      run_busy_poll(server_context, server_config);
+    } else {
+      auto work = asio::make_work_guard(server_context);
+      server_context.run();
+    }
+  });
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(PING_NUM);
+  asio::io_context context;
+  rpc_client client(context, rpc_config{.socket_nodelay = 1});
+  std::function<void(const std::shared_ptr<rpc_core::rpc>&)> ping = [&](const std::shared_ptr<rpc_core::rpc>& rpc) {
+    auto start = std::chrono::steady_clock::now();
+    rpc->cmd("ping")
+        ->msg(std::string("ping"))
+        ->rsp([&, rpc, start](const std::string& data) {
+          latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+          ASSERT(data == "ping");
+          if (latencies.size() == PING_NUM) {
+            client.stop();
+            return;
+          }
+          ping(rpc);
+        })
+        ->call();
+  };
+  client.on_open = ping;
+  client.open("localhost", PORT);
+  if (config) {
+    busy_poll_config client_config = *config;
+    client_config.cpu = 0;
+    client.run_busy_poll(client_config);
+  } else {
+    client.run();
+  }
+
+  server_context.stop();
+  server_thread.join();
+
+  ASSERT(latencies.size() == PING_NUM);
+  std::sort(latencies.begin(), latencies.end());
+  int64_t sum = 0;
+  for (auto latency : latencies) sum += latency;
+  auto percentile = [&](double p) {
+    return (double)latencies[std::min((size_t)(latencies.size() * p), latencies.size() - 1)] / 1000;
+  };
+  LOG("%s: avg: %.1fus, p50: %.1fus, p99: %.1fus, p999: %.1fus", name, (double)sum / latencies.size() / 1000, percentile(0.5),
+      percentile(0.99), percentile(0.999));
+}
+
+int main() {
+  test_latency("run", nullptr);
+  // spinning on the same cpu only slows down the peer
+  if (std::thread::hardware_concurrency() < 2) {
+    LOG("busy poll needs a cpu for each spinning thread, skipped");
+    return EXIT_SUCCESS;
+  }
+  busy_poll_config budget{.spin_us = 100};
+  test_latency("busy poll, spin 100us", &budget);
+  busy_poll_config spin{.spin_us = UINT32_MAX};
+  test_latency("busy poll, never block", &spin);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "asio_net/rpc_client.hpp"
+#include "asio_net/rpc_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const uint32_t POOL_SIZE = 2;
+
+static size_t index_of(io_context_pool& pool, asio::io_context& context) {
+  for (size_t i = 0; i < pool.size(); ++i) {
+    if (&pool.get_io_context(i) == &context) return i;
+  }
+  return SIZE_MAX;
+}
+
+int main() {
+#ifdef _WIN32
+  LOG("not supported");
+#else
+  // timeout of call in flight is armed on the old io_context, and runs on the new one
+  auto pool = std::make_shared<io_context_pool>(POOL_SIZE);
+  asio::io_context server_context;
+  rpc_server server(server_context, PORT, rpc_config{.ping_interval_ms = 50, .pong_timeout_ms = 2000});
+  server.set_io_context_pool(pool);
+  std::atomic<bool> migrated{false};
+  std::atomic<bool> timeout{false};
+  server.on_session = [&](const std::weak_ptr<rpc_session>& rs) {
+    auto session = rs.lock();
+    auto from = index_of(*pool, session->get_io_context());
+    auto to = (from + 1) % POOL_SIZE;
+    ASSERT(from != SIZE_MAX);
+    // client replies after timeout
+    session->rpc->cmd("slow")
+        ->msg(std::string("hello"))
+        ->timeout([&, rs, to] {
+          LOG("slow timeout");
+          ASSERT(migrated);
+          ASSERT(pool->get_io_context(to).get_executor().running_in_this_thread());
+          timeout = true;
+          rs.lock()->close();
+        })
+        ->timeout_ms(500)
+        ->call();
+    // quiescent after the call is written
+    auto timer = std::make_shared<asio::steady_timer>(session->get_executor(), std::chrono::milliseconds(100));
+    timer->async_wait([&, rs, to, timer](const std::error_code&) {
+      auto session = rs.lock();
+      if (!session) return;
+      server.migrate(session, to, [&, rs, to](bool ok) {
+        LOG("migrate: %d", ok);
+        ASSERT(ok);
+        ASSERT(&rs.lock()->get_io_context() == &pool->get_io_context(to));
+        migrated = true;
+      });
+    });
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  asio::io_context context;
+  rpc_client client(context);
+  client.on_open = [](const std::shared_ptr<rpc_core::rpc>& rpc) {
+    rpc->subscribe("slow", [](const std::string&) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    });
+  };
+  client.on_close = [&] {
+    context.stop();
+  };
+  client.open("localhost", PORT);
+  context.run();
+  ASSERT(migrated);
+  ASSERT(timeout);
+
+  server_context.stop();
+  server_thread.join();
+#endif
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+/**
+ * connection storm: client threads connect and reset as fast as possible
+ * report sessions accepted per second by single acceptor, io_context_pool, reuse_port shards, and session_pool
+ */
+static void test_accept_rate(const char* name, size_t pool_size, bool reuse_port, uint32_t session_pool_size = 0) {
+  static const uint32_t client_thread_num = 4;
+  static const auto duration = std::chrono::seconds(1);
+
+  std::atomic<uint32_t> accepted{0};
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.reuse_port = reuse_port, .session_pool_size = session_pool_size});
+  if (pool_size) {
+    server.set_io_context_pool(std::make_shared<io_context_pool>(pool_size));
+  }
+  server.on_session = [&](const std::weak_ptr<tcp_session>&) {
+    accepted += 1;
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  std::atomic_bool running{true};
+  std::vector<std::thread> client_threads;
+  for (uint32_t i = 0; i < client_thread_num; ++i) {
+    client_threads.emplace_back([&] {
+      asio::io_context context;
+      asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), PORT);
+      while (running) {
+        asio::ip::tcp::socket socket(context);
+        asio::error_code ec;
+        socket.connect(endpoint, ec);
+        if (ec) continue;
+        // reset instead of close, avoid TIME_WAIT exhaust local ports
+        socket.set_option(asio::socket_base::linger(true, 0), ec);
+        socket.close(ec);
+      }
+    });
+  }
+
+  std::this_thread::sleep_for(duration);
+  uint32_t count = accepted;
+  running = false;
+  for (auto& t : client_threads) t.join();
+  server_context.stop();
+  server_thread.join();
+
+  ASSERT(count > 0);
+  LOG("%s: accepted: %u/s", name, (uint32_t)(count / std::chrono::duration_cast<std::chrono::duration<double>>(duration).count()));
+}
+
+int main() {
+  size_t pool_size = std::max(std::thread::hardware_concurrency() / 2, 1u);
+  test_accept_rate("single acceptor", 0, false);
+  test_accept_rate("io_context_pool", pool_size, false);
+  test_accept_rate("io_context_pool + reuse_port", pool_size, true);
+  test_accept_rate("single acceptor + session_pool", 0, false, 1024);
+  test_accept_rate("io_context_pool + reuse_port + session_pool", pool_size, true, 1024);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+struct client_group {
+  asio::io_context& context;
+  std::vector<std::unique_ptr<tcp_client>> clients;
+  uint32_t closed = 0;
+
+  // connect one by one, wait for server accepted or rejected
+  tcp_client* connect() {
+    clients.emplace_back(std::make_unique<tcp_client>(context));
+    auto client = clients.back().get();
+    client->on_close = [this] {
+      ++closed;
+    };
+    client->open("127.0.0.1", PORT);
+    context.run_for(std::chrono::milliseconds(100));
+    return client;
+  }
+};
+
+int main() {
+  // limiter: idle entries age out
+  {
+    auto limiter = std::make_shared<detail::accept_limiter>(UINT32_MAX, 0, 0);
+    auto token = limiter->admit(asio::ip::make_address("127.0.0.1"));
+    ASSERT(token && limiter->size() == 1);
+    token = nullptr;
+    ASSERT(limiter->size() == 0);
+  }
+  {
+    auto limiter = std::make_shared<detail::accept_limiter>(UINT32_MAX, 10, 1);
+    ASSERT(limiter->admit(asio::ip::make_address("::1")));
+    ASSERT(!limiter->admit(asio::ip::make_address("::1")));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ASSERT(limiter->admit(asio::ip::make_address("127.0.0.1")));
+    // swept a few buckets per admit
+    for (int i = 0; i < 64; ++i) {
+      limiter->admit(asio::ip::make_address("127.0.0.1"));
+    }
+    ASSERT(limiter->size() == 1);
+  }
+  // table stays bounded when every admit comes from a new ip
+  {
+    auto limiter = std::make_shared<detail::accept_limiter>(UINT32_MAX, 1000, 1);
+    for (uint32_t i = 0; i < 100000; ++i) {
+      limiter->admit(asio::ip::address_v4(0x0a000000 + i));
+      if (i % 1000 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    LOG("limiter entries after 100000 ips: %zu", limiter->size());
+    ASSERT(limiter->size() < 100000 / 2);
+  }
+
+  // max_connections_per_ip: third rejected, accepted again after one closed
+  {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.max_connections_per_ip = 2});
+    uint32_t session_num = 0;
+    server.on_session = [&](const std::weak_ptr<tcp_session>&) {
+      ++session_num;
+    };
+    server.start();
+    client_group group{context};
+    auto first = group.connect();
+    group.connect();
+    group.connect();
+    LOG("sessions: %u, rejected: %llu", session_num, (unsigned long long)server.rejected_count());
+    ASSERT(session_num == 2);
+    ASSERT(server.rejected_count() == 1);
+    ASSERT(group.closed == 1);
+    first->close();
+    context.run_for(std::chrono::milliseconds(100));
+    group.connect();
+    ASSERT(session_num == 3);
+    ASSERT(server.session_count() == 2);
+    ASSERT(server.rejected_count() == 1);
+  }
+
+  // accept_rate_per_ip: burst 2, then 1 per second
+  {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.accept_rate_per_ip = 1, .accept_burst_per_ip = 2});
+    uint32_t session_num = 0;
+    server.on_session = [&](const std::weak_ptr<tcp_session>&) {
+      ++session_num;
+    };
+    server.start();
+    client_group group{context};
+    for (int i = 0; i < 4; ++i) {
+      group.connect();
+    }
+    LOG("sessions: %u, rejected: %llu", session_num, (unsigned long long)server.rejected_count());
+    ASSERT(session_num == 2);
+    ASSERT(server.rejected_count() == 2);
+    context.run_for(std::chrono::milliseconds(1000));
+    group.connect();
+    ASSERT(session_num == 3);
+  }
+  return EXIT_SUCCESS;
+}
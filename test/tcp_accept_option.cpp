@@ -0,0 +1,97 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+  static std::atomic<uint32_t> session_num{0};
+  std::thread([] {
+    asio::io_context context;
+    tcp_server server(context, PORT,
+                      tcp_config{.auto_pack = true,
+                                 .accept_backlog = 16,
+                                 .accept_pending = 4,
+                                 .accept_retry_min_ms = 10,
+                                 .accept_retry_max_ms = 100,
+                                 .socket_defer_accept_s = 1,
+                                 .socket_fastopen = 16});
+    server.on_session = [](const std::weak_ptr<tcp_session>& ws) {
+      LOG("on_session:");
+      session_num += 1;
+      ws.lock()->on_data = [ws](std::string data) {
+        ws.lock()->send(std::move(data));
+      };
+    };
+    server.start(true);
+  }).detach();
+
+  // echo with multiple pending accepts, client send first for TCP_DEFER_ACCEPT
+  std::thread([] {
+    asio::io_context context;
+    std::vector<std::unique_ptr<tcp_client>> clients;
+    uint32_t finish_num = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+      clients.emplace_back(std::make_unique<tcp_client>(context, tcp_config{.auto_pack = true}));
+      auto client = clients.back().get();
+      client->on_open = [client] {
+        client->send("hello");
+      };
+      client->on_data = [&, client](const std::string& data) {
+        ASSERT(data == "hello");
+        client->close();
+        if (++finish_num == 8) context.stop();
+      };
+      client->open("localhost", PORT);
+    }
+    context.run();
+  }).join();
+  ASSERT(session_num == 8);
+
+#ifndef _WIN32
+  // accept fail with EMFILE, and retry after fds available
+  {
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    auto origin = limit;
+    limit.rlim_cur = std::min<rlim_t>(limit.rlim_cur, 256);
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    asio::io_context context;
+    asio::ip::tcp::socket socket(context);
+    socket.open(asio::ip::tcp::v4());
+    std::vector<int> fds;
+    for (;;) {
+      int fd = ::dup(0);
+      if (fd < 0) break;
+      fds.push_back(fd);
+    }
+    LOG("exhaust fds: %zu", fds.size());
+    // completed by kernel, accept will fail
+    socket.connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), PORT));
+    asio::write(socket, asio::buffer("\x01\x00\x00\x00x", 5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT(session_num == 8);
+
+    for (int fd : fds) ::close(fd);
+    setrlimit(RLIMIT_NOFILE, &origin);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT(session_num == 9);
+  }
+#endif
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client_pool.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const uint32_t POOL_SIZE = 4;
+const uint32_t MESSAGE_NUM = 100;
+const size_t KEY = 7;
+
+int main() {
+  // server: echo, and record which session each message arrived on
+  std::mutex mutex;
+  std::map<const void*, std::vector<std::string>> received;
+  std::vector<std::weak_ptr<tcp_session>> sessions;
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.auto_pack = true});
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    sessions.push_back(ws);
+    ws.lock()->on_data = [&, ws](std::string data) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        received[ws.lock().get()].push_back(data);
+      }
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  asio::io_context context;
+  tcp_client_pool pool(context, client_pool_config{.pool_size = POOL_SIZE, .reconnect_ms = 100}, tcp_config{.auto_pack = true});
+  ASSERT(pool.size() == POOL_SIZE);
+  ASSERT(!pool.send("nothing open"));
+  uint32_t echo_count = 0;
+  int step = 0;
+  pool.on_open = [&] {
+    // pre-warmed: all connections open before first send
+    ASSERT(pool.open_count() == POOL_SIZE);
+    step = 1;
+    for (uint32_t i = 0; i < MESSAGE_NUM; ++i) {
+      ASSERT(pool.send("any"));
+      ASSERT(pool.send_by_key(KEY, std::to_string(i)));
+    }
+  };
+  pool.on_data = [&](const std::string&) {
+    if (++echo_count == MESSAGE_NUM * 2) context.stop();
+  };
+  pool.open("localhost", PORT);
+  context.run();
+  ASSERT(step == 1);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT(received.size() == POOL_SIZE);
+    // unkeyed messages spread over connections, keyed ones stay on one in order
+    uint32_t keyed_sessions = 0;
+    for (auto& item : received) {
+      std::vector<std::string> keyed;
+      uint32_t any = 0;
+      for (auto& msg : item.second) {
+        if (msg == "any") {
+          ++any;
+        } else {
+          keyed.push_back(msg);
+        }
+      }
+      LOG("session: any %u, keyed %zu", any, keyed.size());
+      if (keyed.empty()) {
+        ASSERT(any > 0);
+        continue;
+      }
+      ++keyed_sessions;
+      for (uint32_t i = 0; i < keyed.size(); ++i) {
+        ASSERT(keyed[i] == std::to_string(i));
+      }
+    }
+    ASSERT(keyed_sessions == 1);
+  }
+
+  // close the connection of key on server side, key moves to the next one, then reconnected independently
+  auto keyed = pool.select(KEY);
+  ASSERT(keyed == KEY % POOL_SIZE);
+  asio::post(server_context, [&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& ws : sessions) {
+      auto session = ws.lock();
+      if (session && received[session.get()].size() > MESSAGE_NUM) session->close();
+    }
+  });
+  context.restart();
+  asio::steady_timer timer(context);
+  bool moved = false;
+  std::function<void()> check = [&] {
+    if (!pool.is_open(keyed)) {
+      ASSERT(pool.open_count() == POOL_SIZE - 1);
+      ASSERT(pool.select(KEY) == (keyed + 1) % POOL_SIZE);
+      moved = true;
+    } else if (moved && pool.open_count() == POOL_SIZE) {
+      ASSERT(pool.select(KEY) == keyed);
+      context.stop();
+      return;
+    }
+    timer.expires_after(std::chrono::milliseconds(10));
+    timer.async_wait([&](const std::error_code&) {
+      check();
+    });
+  };
+  check();
+  context.run();
+  ASSERT(moved);
+  LOG("reconnected");
+
+  pool.close();
+  server_context.stop();
+  server_thread.join();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const uint32_t THREAD_NUM = 4;
+const uint32_t CLIENT_NUM = 16;
+const uint32_t MESSAGE_NUM = 100;
+
+int main() {
+  // io_context keeps blocking behaviors, others are concurrent
+  {
+    asio::io_context context;
+    asio::thread_pool pool(1);
+    ASSERT(!detail::io_executor(context).is_concurrent());
+    ASSERT(detail::io_executor(context).io_context() == &context);
+    ASSERT(detail::io_executor(asio::make_strand(context)).is_concurrent());
+    ASSERT(detail::io_executor(asio::make_strand(context)).io_context() == &context);
+    ASSERT(detail::io_executor(pool.get_executor()).is_concurrent());
+    ASSERT(detail::io_executor(pool.get_executor()).io_context() == nullptr);
+    ASSERT(&detail::io_executor(asio::make_strand(context)).get_io_context() == &context);
+    bool thrown = false;
+    try {
+      detail::io_executor(pool.get_executor()).get_io_context();
+    } catch (const std::logic_error&) {
+      thrown = true;
+    }
+    ASSERT(thrown);
+    pool.join();
+  }
+
+  // server and clients on one thread pool, each session on its own strand
+  asio::thread_pool pool(THREAD_NUM);
+  tcp_server server(pool.get_executor(), PORT, tcp_config{.auto_pack = true});
+  std::atomic<uint32_t> session_count{0};
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    session_count += 1;
+    // no io_context behind a thread pool
+    bool thrown = false;
+    try {
+      ws.lock()->get_io_context();
+    } catch (const std::logic_error&) {
+      thrown = true;
+    }
+    ASSERT(thrown);
+    auto busy = std::make_shared<std::atomic<bool>>(false);
+    ws.lock()->on_data = [ws, busy](std::string data) {
+      // handlers of a session never run concurrently
+      ASSERT(!busy->exchange(true));
+      ws.lock()->send(std::move(data));
+      busy->store(false);
+    };
+  };
+  server.start();
+
+  std::atomic<uint32_t> done_count{0};
+  std::promise<void> all_done;
+  std::vector<std::unique_ptr<tcp_client>> clients;
+  for (uint32_t i = 0; i < CLIENT_NUM; ++i) {
+    clients.emplace_back(std::make_unique<tcp_client>(asio::make_strand(pool), tcp_config{.auto_pack = true}));
+    auto client = clients.back().get();
+    auto received = std::make_shared<uint32_t>(0);
+    client->on_open = [client] {
+      for (uint32_t n = 0; n < MESSAGE_NUM; ++n) {
+        client->send(std::to_string(n));
+      }
+    };
+    client->on_data = [&, client, received](const std::string& data) {
+      // echo in order
+      ASSERT(data == std::to_string(*received));
+      if (++*received == MESSAGE_NUM) {
+        client->close();
+        if (++done_count == CLIENT_NUM) all_done.set_value();
+      }
+    };
+    asio::post(client->get_executor(), [client] {
+      client->open("localhost", PORT);
+    });
+  }
+  ASSERT(all_done.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  LOG("sessions: %u, messages: %u", session_count.load(), CLIENT_NUM * MESSAGE_NUM);
+  ASSERT(session_count == CLIENT_NUM);
+
+  // sessions removed from their own strands
+  while (server.session_count() != 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // broadcast dispatched on strand of each session
+  std::atomic<uint32_t> broadcast_count{0};
+  std::promise<void> all_broadcast;
+  std::atomic<bool> broadcast_sent{false};
+  server.on_session = [&](const std::weak_ptr<tcp_session>&) {
+    // on_session of sessions may run concurrently
+    if (server.session_count() == CLIENT_NUM && !broadcast_sent.exchange(true)) server.broadcast("broadcast");
+  };
+  // clients of echo may still be in their handlers, destroyed after pool joined
+  for (uint32_t i = 0; i < CLIENT_NUM; ++i) {
+    clients.emplace_back(std::make_unique<tcp_client>(asio::make_strand(pool), tcp_config{.auto_pack = true}));
+    auto client = clients.back().get();
+    client->on_data = [&, client](const std::string& data) {
+      ASSERT(data == "broadcast");
+      client->close();
+      if (++broadcast_count == CLIENT_NUM) all_broadcast.set_value();
+    };
+    asio::post(client->get_executor(), [client] {
+      client->open("localhost", PORT);
+    });
+  }
+  ASSERT(all_broadcast.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+  pool.stop();
+  pool.join();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+#ifndef _WIN32
+  // systemd environment is consumed, children not adopt the fds again
+  {
+    ::setenv("LISTEN_PID", std::to_string(::getpid()).c_str(), 1);
+    ::setenv("LISTEN_FDS", "0", 1);
+    ASSERT(systemd_listen_fds().empty());
+    ASSERT(!std::getenv("LISTEN_PID") && !std::getenv("LISTEN_FDS"));
+  }
+
+  // adopting an invalid fd throws, and the fd is closed
+  {
+    int pipe_fds[2];
+    ASSERT(::pipe(pipe_fds) == 0);
+    ::close(pipe_fds[1]);
+    int fd = pipe_fds[0];
+    asio::io_context context;
+    bool thrown = false;
+    try {
+      tcp_server server(context, listen_fd{fd});
+    } catch (const std::system_error& e) {
+      LOG("adopt failed: %s", e.what());
+      thrown = true;
+    }
+    ASSERT(thrown);
+    ASSERT(::fcntl(fd, F_GETFD) < 0);
+  }
+
+  // accepted before the acceptor closed by drain, session closed too
+  {
+    asio::io_context context;
+    tcp_server server(context, PORT);
+    server.on_session = [](const std::weak_ptr<tcp_session>&) {
+      ASSERT(false);
+    };
+    std::vector<asio::ip::tcp::socket> clients;
+    for (int i = 0; i < 3; ++i) {
+      clients.emplace_back(context);
+      clients.back().connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), PORT));
+    }
+    // accept completes at start, the handler runs after drain
+    server.start();
+    server.drain(std::chrono::seconds(5));
+    context.run_for(std::chrono::milliseconds(100));
+    for (auto& client : clients) {
+      char data;
+      asio::error_code ec;
+      client.read_some(asio::buffer(&data, 1), ec);
+      ASSERT(ec == asio::error::eof || ec == asio::error::connection_reset);
+    }
+    ASSERT(server.session_count() == 0);
+  }
+
+  const std::string big_data(8 * 1024 * 1024, 'x');
+
+  // old server: reply big data and drain when asked, queued data should be flushed before close
+  asio::io_context context_a;
+  tcp_server server_a(context_a, PORT, tcp_config{.auto_pack = true});
+  uint32_t session_num_a = 0;
+  server_a.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    LOG("server a on_session:");
+    ++session_num_a;
+    ws.lock()->on_data = [&, ws](const std::string& data) {
+      ASSERT(data == "drain");
+      ws.lock()->send(big_data);
+      server_a.drain(std::chrono::seconds(5));
+    };
+  };
+  std::thread thread_a([&] {
+    server_a.start(true);
+  });
+
+  // client 1 connected to old server before handoff
+  asio::io_context context_c;
+  tcp_client client_1(context_c, tcp_config{.auto_pack = true, .max_body_size = 16 * 1024 * 1024});
+  std::promise<void> opened;
+  client_1.on_open = [&] {
+    LOG("client 1 on_open:");
+    opened.set_value();
+  };
+  bool received = false;
+  client_1.on_data = [&](const std::string& data) {
+    received = data == big_data;
+  };
+  std::promise<void> closed;
+  client_1.on_close = [&] {
+    LOG("client 1 on_close:");
+    closed.set_value();
+  };
+  client_1.open("localhost", PORT);
+  std::thread thread_c([&] {
+    client_1.run();
+  });
+  opened.get_future().wait();
+
+  // handoff listening socket to new server
+  asio::io_context context_b;
+  asio::local::stream_protocol::socket sender(context_b), receiver(context_b);
+  asio::local::connect_pair(sender, receiver);
+  ASSERT(send_listen_fd(sender, server_a.native_handle()));
+  auto fd = recv_listen_fd(receiver);
+  ASSERT(fd.fd >= 0);
+  ASSERT(::fcntl(fd.fd, F_GETFD) & FD_CLOEXEC);
+  tcp_server server_b(context_b, fd, tcp_config{.auto_pack = true});
+  uint32_t session_num_b = 0;
+  server_b.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    LOG("server b on_session:");
+    ++session_num_b;
+    ws.lock()->on_data = [ws](std::string data) {
+      ws.lock()->send(std::move(data));
+    };
+  };
+  std::thread thread_b([&] {
+    server_b.start(true);
+  });
+
+  // old server drains
+  asio::post(context_c, [&] {
+    client_1.send("drain");
+  });
+  closed.get_future().wait();
+  ASSERT(received);
+
+  // new connections served by new server
+  std::thread([] {
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.auto_pack = true});
+    client.on_open = [&] {
+      client.send("hello");
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(data == "hello");
+      client.close();
+    };
+    client.on_close = [&] {
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+
+  client_1.stop();
+  context_a.stop();
+  context_b.stop();
+  thread_a.join();
+  thread_b.join();
+  thread_c.join();
+  ASSERT(session_num_a == 1);
+  ASSERT(session_num_b == 1);
+  ASSERT(server_a.session_count() == 0);
+#endif
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+  std::thread([] {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.auto_pack = true, .tcp_info_interval_ms = 10});
+    server.on_session = [](const std::weak_ptr<tcp_session>& ws) {
+      LOG("on_session:");
+      auto session = ws.lock();
+      session->on_data = [ws](std::string data) {
+        auto session = ws.lock();
+#ifdef __linux__
+        // sampled after connected
+        ASSERT(session->stats().tcp_info.valid);
+#endif
+        session->send(std::move(data));
+      };
+    };
+    server.start(true);
+  }).detach();
+
+  std::thread([] {
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.auto_pack = true});
+    uint32_t count = 0;
+    client.on_open = [&] {
+      LOG("client on_open:");
+      // not sampled if tcp_info_interval_ms not set
+      ASSERT(!client.stats().tcp_info.valid);
+      client.send(std::string(1024, 'x'));
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(data.size() == 1024);
+      if (++count < 100) {
+        client.send(data);
+        return;
+      }
+      auto info = client.tcp_info();
+      LOG("tcp_info: valid: %d, rtt: %uus, rttvar: %uus, cwnd: %u, mss: %u, retrans: %u/%u, acked: %llu, notsent: %u", info.valid, info.rtt_us,
+          info.rttvar_us, info.snd_cwnd, info.snd_mss, info.retransmits, info.total_retrans, (unsigned long long)info.bytes_acked,
+          info.notsent_bytes);
+#if defined(__linux__) || defined(__APPLE__)
+      ASSERT(info.valid);
+      ASSERT(info.snd_cwnd > 0);
+      ASSERT(info.snd_mss > 0);
+#endif
+#ifdef __linux__
+      // all sent data is acked before echo
+      ASSERT(info.bytes_acked >= 1024 * 100);
+      ASSERT(info.notsent_bytes == 0);
+#endif
+      client.close();
+    };
+    client.on_close = [&] {
+      LOG("client on_close:");
+      ASSERT(!client.tcp_info().valid);
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+  return EXIT_SUCCESS;
+}
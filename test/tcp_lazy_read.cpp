@@ -0,0 +1,173 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+/**
+ * count allocations not smaller than a read buffer
+ */
+static const uint32_t buffer_size = 64 * 1024;
+static std::atomic<uint32_t> buffer_allocs{0};
+
+struct alignas(std::max_align_t) block_header {
+  size_t size;
+};
+
+void* operator new(size_t size) {
+  auto header = (block_header*)std::malloc(sizeof(block_header) + size);
+  if (!header) throw std::bad_alloc();
+  header->size = size;
+  if (size >= buffer_size) buffer_allocs += 1;
+  return header + 1;
+}
+
+void operator delete(void* p) noexcept {
+  if (!p) return;
+  std::free((block_header*)p - 1);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+/**
+ * idle sessions hold no read buffer with lazy_read, and share one buffer of the io thread after read
+ */
+static void test_idle_buffer(bool lazy_read) {
+  LOG("test_idle_buffer: lazy_read: %d", lazy_read);
+  static const uint32_t session_num = 10;
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.max_body_size = buffer_size, .lazy_read = lazy_read});
+  std::atomic<uint32_t> session_count{0};
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    session_count += 1;
+    ws.lock()->on_data = [ws](std::string data) {
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  asio::io_context context;
+  std::vector<asio::ip::tcp::socket> clients;
+  for (uint32_t i = 0; i < session_num; ++i) {
+    clients.emplace_back(context);
+    clients.back().connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), PORT));
+  }
+  while (session_count != session_num) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  uint32_t idle_allocs = buffer_allocs.exchange(0);
+  LOG("idle: buffer allocs: %u", idle_allocs);
+  if (lazy_read) {
+    ASSERT(idle_allocs == 0);
+  } else {
+    ASSERT(idle_allocs >= session_num);
+  }
+
+  if (lazy_read) {
+    for (auto& client : clients) {
+      char byte = 'x';
+      asio::write(client, asio::buffer(&byte, 1));
+      asio::read(client, asio::buffer(&byte, 1));
+      ASSERT(byte == 'x');
+    }
+    // thread local buffer allocated once
+    LOG("after read: buffer allocs: %u", buffer_allocs.load());
+    ASSERT(buffer_allocs <= 1);
+  }
+
+  clients.clear();
+  server_context.stop();
+  server_thread.join();
+  buffer_allocs = 0;
+}
+
+static void test_lazy_read(bool auto_pack) {
+  LOG("test_lazy_read: auto_pack: %d", auto_pack);
+  static const uint32_t test_count_max = 1000;
+  static const uint32_t test_data_size = 1024 * 100;
+  tcp_config config{.auto_pack = auto_pack, .lazy_read = true};
+
+  // server
+  std::thread([config] {
+    asio::io_context context;
+    tcp_server server(context, PORT, config);
+    server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+      LOG("on_session:");
+      auto session = ws.lock();
+      session->on_close = [&] {
+        LOG("session on_close:");
+        context.stop();
+      };
+      session->on_data = [ws](std::string data) {
+        ASSERT(!ws.expired());
+        ws.lock()->send(std::move(data));
+      };
+    };
+    server.start(true);
+  }).detach();
+
+  // client
+  std::thread([config, auto_pack] {
+    asio::io_context context;
+    tcp_client client(context, config);
+    uint32_t test_count_expect = 0;
+    std::string recv_data;
+    client.on_open = [&] {
+      LOG("client on_open:");
+      if (auto_pack) {
+        for (uint32_t i = 0; i < test_count_max; ++i) {
+          client.send(std::to_string(i));
+        }
+      } else {
+        client.send(std::string(test_data_size, 'x'));
+      }
+    };
+    client.on_data = [&](std::string data) {
+      if (auto_pack) {
+        ASSERT(std::to_string(test_count_expect++) == data);
+        if (test_count_expect == test_count_max) {
+          client.close();
+        }
+      } else {
+        recv_data += data;
+        if (recv_data.size() == test_data_size) {
+          ASSERT(recv_data == std::string(test_data_size, 'x'));
+          client.close();
+        }
+      }
+    };
+    client.on_close = [&] {
+      LOG("client on_close:");
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+
+  // wait server stop
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+int main() {
+  test_idle_buffer(false);
+  test_idle_buffer(true);
+  test_lazy_read(true);
+  test_lazy_read(false);
+  return EXIT_SUCCESS;
+}
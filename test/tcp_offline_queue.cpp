@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+static void test_policy() {
+  asio::io_context context;
+
+  // disabled by default, sent to closed socket
+  {
+    tcp_client client(context);
+    ASSERT(client.send("lost"));
+    ASSERT(client.offline_queue_size() == 0);
+  }
+
+  {
+    tcp_client client(context, tcp_config{.offline_queue_messages = 2, .offline_queue_policy = offline_policy::drop_oldest});
+    ASSERT(client.send("1") && client.send("2") && client.send("3"));
+    ASSERT(client.offline_queue_size() == 2);
+    ASSERT(client.offline_dropped() == 1);
+  }
+
+  {
+    tcp_client client(context, tcp_config{.offline_queue_messages = 2, .offline_queue_policy = offline_policy::drop_newest});
+    ASSERT(client.send("1") && client.send("2"));
+    ASSERT(!client.send("3"));
+    ASSERT(client.offline_queue_size() == 2);
+    ASSERT(client.offline_dropped() == 1);
+  }
+
+  {
+    tcp_client client(context, tcp_config{.offline_queue_messages = 2, .offline_queue_policy = offline_policy::reject});
+    ASSERT(client.send("1") && client.send("2"));
+    ASSERT(!client.send(std::make_shared<const std::string>("3")));
+    ASSERT(client.offline_queue_size() == 2);
+    ASSERT(client.offline_dropped() == 0);
+  }
+
+  // bytes limit, message larger than the limit never fits
+  {
+    tcp_client client(context, tcp_config{.offline_queue_messages = 100, .offline_queue_bytes = 4});
+    ASSERT(client.send("12") && client.send("34") && client.send("56"));
+    ASSERT(client.offline_queue_size() == 2);
+    ASSERT(!client.send("12345"));
+    ASSERT(client.offline_queue_size() == 2);
+    ASSERT(client.offline_dropped() == 2);
+  }
+}
+
+static void test_replay() {
+  // server: record messages of all sessions in order, close session on "close", echo "end"
+  std::mutex mutex;
+  std::vector<std::string> received;
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.auto_pack = true});
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    ws.lock()->on_data = [&, ws](std::string data) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(data);
+      }
+      if (data == "close") {
+        ws.lock()->close();
+      } else if (data == "end") {
+        ws.lock()->send(std::move(data));
+      }
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  asio::io_context context;
+  tcp_client client(context, tcp_config{.auto_pack = true, .offline_queue_messages = 3});
+  // queued before the first open, oldest dropped
+  for (int i = 1; i <= 4; ++i) {
+    ASSERT(client.send(std::to_string(i)));
+  }
+  ASSERT(client.offline_queue_size() == 3);
+  int open_count = 0;
+  client.on_open = [&] {
+    // queued messages already sent
+    ASSERT(client.offline_queue_size() == 0);
+    if (++open_count == 1) {
+      client.send("close");
+    } else {
+      client.send("end");
+    }
+  };
+  client.on_close = [&] {
+    if (open_count != 1) return;
+    // sent while disconnected, replayed on reconnect
+    ASSERT(client.send("5"));
+    ASSERT(client.send("6", std::chrono::seconds(10)));
+    ASSERT(client.offline_queue_size() == 2);
+  };
+  client.on_data = [&](const std::string& data) {
+    ASSERT(data == "end");
+    client.stop();
+  };
+  client.set_reconnect(50);
+  client.open("localhost", PORT);
+  client.run();
+  ASSERT(open_count == 2);
+  ASSERT(client.offline_dropped() == 1);
+
+  server_context.stop();
+  server_thread.join();
+
+  const std::vector<std::string> expect = {"2", "3", "4", "close", "5", "6", "end"};
+  ASSERT(received == expect);
+}
+
+int main() {
+  LOG("test policy");
+  test_policy();
+  LOG("test replay");
+  test_replay();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+  static const uint32_t test_count_max = 1000;
+  static const uint32_t test_backlog_max = 10;
+
+  // server: consume slowly, pause read by backlog
+  static std::atomic_bool pass_flag_backlog{false};
+  std::thread([] {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.auto_pack = true, .read_backlog_high = test_backlog_max, .read_backlog_low = 0});
+    std::deque<std::string> backlog;
+    asio::steady_timer consume_timer(context);
+    std::function<void(std::weak_ptr<tcp_session>)> consume = [&](const std::weak_ptr<tcp_session>& ws) {
+      consume_timer.expires_after(std::chrono::milliseconds(1));
+      consume_timer.async_wait([&, ws](const std::error_code& ec) {
+        if (ec) return;
+        auto session = ws.lock();
+        if (!session) return;
+        while (!backlog.empty()) {
+          session->send(std::move(backlog.front()));
+          backlog.pop_front();
+        }
+        session->set_read_backlog(0);
+        ASSERT(!session->is_read_paused());
+        consume(ws);
+      });
+    };
+    server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+      LOG("on_session:");
+      auto session = ws.lock();
+      session->on_close = [&] {
+        LOG("session on_close:");
+        consume_timer.cancel();
+      };
+      session->on_data = [&, ws](std::string data) {
+        backlog.push_back(std::move(data));
+        ASSERT(backlog.size() <= test_backlog_max);
+        if (backlog.size() == test_backlog_max) pass_flag_backlog = true;
+        ws.lock()->set_read_backlog((uint32_t)backlog.size());
+      };
+      consume(ws);
+    };
+    server.start(true);
+  }).detach();
+
+  // client: pause read manually
+  static std::atomic_bool pass_flag_client_pause{false};
+  std::thread([] {
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.auto_pack = true});
+    uint32_t test_count_expect = 0;
+    asio::steady_timer resume_timer(context);
+    client.on_open = [&] {
+      LOG("client on_open:");
+      for (uint32_t i = 0; i < test_count_max; ++i) {
+        client.send(std::to_string(i));
+      }
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(!client.is_read_paused());
+      ASSERT(std::to_string(test_count_expect++) == data);
+      if (test_count_expect == test_count_max / 2) {
+        LOG("client pause_read:");
+        client.pause_read();
+        resume_timer.expires_after(std::chrono::milliseconds(100));
+        resume_timer.async_wait([&](const std::error_code&) {
+          LOG("client resume_read:");
+          pass_flag_client_pause = true;
+          client.resume_read();
+        });
+      }
+      if (test_count_expect == test_count_max) {
+        client.close();
+      }
+    };
+    client.on_close = [&] {
+      LOG("client on_close:");
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+
+  ASSERT(pass_flag_backlog);
+  ASSERT(pass_flag_client_pause);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+static const uint64_t test_rate = 1024 * 1024 * 10;
+static const uint32_t test_data_size = 1024 * 64;
+
+/**
+ * @param server_config config for server
+ * @param client_config config for clients
+ * @param client_num clients connect at the same time
+ * @param total_size total bytes send by all clients
+ * @return average bytes per second of server receive, timed from the first data to exclude connect
+ */
+static double test_rate_limit(const tcp_config& server_config, const tcp_config& client_config, uint32_t client_num, uint32_t total_size) {
+  std::atomic<double> rate{0};
+
+  // server
+  std::thread server_thread([&] {
+    asio::io_context context;
+    tcp_server server(context, PORT, server_config);
+    uint32_t recv_size = 0;
+    uint32_t first_size = 0;
+    std::chrono::steady_clock::time_point start;
+    server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+      auto session = ws.lock();
+      session->on_data = [&](const std::string& data) {
+        if (recv_size == 0) {
+          start = std::chrono::steady_clock::now();
+          first_size = (uint32_t)data.size();
+        }
+        recv_size += (uint32_t)data.size();
+        if (recv_size == total_size) {
+          auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          rate = (total_size - first_size) / elapsed;
+          context.stop();
+        }
+      };
+    };
+    server.start(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // clients
+  asio::io_context context;
+  std::vector<std::unique_ptr<tcp_client>> clients;
+  for (uint32_t i = 0; i < client_num; ++i) {
+    clients.emplace_back(std::make_unique<tcp_client>(context, client_config));
+    auto client = clients.back().get();
+    client->on_open = [client, client_num, total_size] {
+      for (uint32_t size = 0; size < total_size / client_num; size += test_data_size) {
+        client->send(std::string(test_data_size, 'x'));
+      }
+    };
+    client->on_close = [&] {
+      context.stop();
+    };
+    client->open("localhost", PORT);
+  }
+  context.run();
+  server_thread.join();
+  return rate;
+}
+
+int main() {
+  // never faster than the limit, the burst allowance and clock jitter aside, slower is allowed on loaded machines
+  const double rate_max = test_rate * 1.05;
+
+  // send rate limit
+  {
+    tcp_config client_config{.auto_pack = true, .send_rate_limit = test_rate, .send_rate_burst = test_data_size};
+    auto rate = test_rate_limit(tcp_config{.auto_pack = true}, client_config, 1, test_rate);
+    LOG("send rate limit: %.0f bytes/s, limit: %llu", rate, (unsigned long long)test_rate);
+    ASSERT(rate < rate_max);
+  }
+
+  // recv rate limit, shared by sessions
+  {
+    tcp_config server_config{.auto_pack = true};
+    server_config.shared_recv_bucket = std::make_shared<token_bucket>(test_rate, test_data_size);
+    auto rate = test_rate_limit(server_config, tcp_config{.auto_pack = true}, 2, test_rate);
+    LOG("shared recv rate limit: %.0f bytes/s, limit: %llu", rate, (unsigned long long)test_rate);
+    ASSERT(rate < rate_max);
+  }
+  return EXIT_SUCCESS;
+}
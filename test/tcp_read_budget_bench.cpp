@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+/**
+ * one chatty client floods the server, other quiet clients do ping-pong on the same server io thread
+ * report quiet clients round trip latency, with and without read budget
+ */
+static void test_read_budget(uint32_t read_budget_messages) {
+  static const uint32_t quiet_client_num = 8;
+  static const uint32_t ping_count = 200;
+  static const uint32_t chatty_msg_size = 1024;
+
+  // server
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.auto_pack = true, .read_budget_messages = read_budget_messages});
+  server.on_session = [](const std::weak_ptr<tcp_session>& ws) {
+    auto session = ws.lock();
+    session->on_data = [ws](std::string data) {
+      if (data.size() == chatty_msg_size) {
+        // simulate some work for chatty data
+        volatile uint32_t sum = 0;
+        for (auto c : data) sum += (uint8_t)c;
+        return;
+      }
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  // chatty client: keep send buffer full
+  std::atomic_bool chatty_running{true};
+  std::thread chatty_thread([&] {
+    asio::io_context context;
+    tcp_client chatty(context, tcp_config{.auto_pack = true, .max_send_buffer_size = 1024 * 1024});
+    chatty.on_open = [&] {
+      while (chatty_running && chatty.is_open) {
+        chatty.send(std::string(chatty_msg_size, 'x'));
+      }
+      chatty.close();
+    };
+    chatty.on_close = [&] {
+      chatty.stop();
+    };
+    chatty.open("localhost", PORT);
+    chatty.run();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  asio::io_context context;
+
+  // quiet clients
+  std::vector<std::chrono::microseconds> latency;
+  uint32_t finished_num = 0;
+  std::vector<std::unique_ptr<tcp_client>> clients;
+  for (uint32_t i = 0; i < quiet_client_num; ++i) {
+    clients.emplace_back(std::make_unique<tcp_client>(context, tcp_config{.auto_pack = true}));
+    auto client = clients.back().get();
+    auto count = std::make_shared<uint32_t>(0);
+    auto send_time = std::make_shared<std::chrono::steady_clock::time_point>();
+    auto ping = [client, send_time] {
+      *send_time = std::chrono::steady_clock::now();
+      client->send("ping");
+    };
+    client->on_open = ping;
+    client->on_data = [&, client, count, send_time, ping](const std::string& data) {
+      ASSERT(data == "ping");
+      latency.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - *send_time));
+      if (++*count == ping_count) {
+        client->close();
+        if (++finished_num == quiet_client_num) {
+          chatty_running = false;
+          context.stop();
+        }
+        return;
+      }
+      ping();
+    };
+    client->open("localhost", PORT);
+  }
+  context.run();
+  chatty_thread.join();
+  server_context.stop();
+  server_thread.join();
+
+  ASSERT(latency.size() == quiet_client_num * ping_count);
+  std::sort(latency.begin(), latency.end());
+  LOG("read_budget_messages: %u, quiet clients latency: p50: %lldus, p99: %lldus, max: %lldus", read_budget_messages,
+      (long long)latency[latency.size() / 2].count(), (long long)latency[latency.size() * 99 / 100].count(), (long long)latency.back().count());
+}
+
+int main() {
+  test_read_budget(0);
+  test_read_budget(16);
+  return EXIT_SUCCESS;
+}
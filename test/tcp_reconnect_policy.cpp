@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const uint16_t CLOSED_PORT = 6667;
+
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * client and server bits of net.ipv4.tcp_fastopen, server side is off by default
+ */
+static bool fastopen_enabled() {
+  std::ifstream file("/proc/sys/net/ipv4/tcp_fastopen");
+  int value = 0;
+  file >> value;
+  return (value & 3) == 3;
+}
+
+/**
+ * intervals between open failures to a closed port, ms
+ */
+static std::vector<int64_t> reconnect_intervals(tcp_config config, uint32_t reconnect_ms, size_t count) {
+  asio::io_context context;
+  tcp_client client(context, config);
+  std::vector<clock_type::time_point> failures;
+  client.on_open = [] {
+    ASSERT(false);
+  };
+  client.on_open_failed = [&](std::error_code) {
+    failures.push_back(clock_type::now());
+    if (failures.size() == count + 1) client.stop();
+  };
+  client.set_reconnect(reconnect_ms);
+  client.open("127.0.0.1", CLOSED_PORT);
+  client.run();
+
+  std::vector<int64_t> intervals;
+  for (size_t i = 1; i < failures.size(); ++i) {
+    intervals.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(failures[i] - failures[i - 1]).count());
+  }
+  return intervals;
+}
+
+static void test_backoff() {
+  auto intervals = reconnect_intervals(tcp_config{.reconnect_max_ms = 160}, 20, 6);
+  const std::vector<int64_t> expect = {20, 40, 80, 160, 160, 160};
+  for (size_t i = 0; i < intervals.size(); ++i) {
+    LOG("backoff: %lld ms", (long long)intervals[i]);
+    ASSERT(intervals[i] >= expect[i] - 2 && intervals[i] <= expect[i] + 100);
+  }
+}
+
+static void test_jitter() {
+  auto intervals = reconnect_intervals(tcp_config{.reconnect_jitter_percent = 50}, 40, 8);
+  for (auto interval : intervals) {
+    LOG("jitter: %lld ms", (long long)interval);
+    ASSERT(interval >= 20 - 2 && interval <= 60 + 100);
+  }
+  auto minmax = std::minmax_element(intervals.begin(), intervals.end());
+  ASSERT(*minmax.second - *minmax.first > 3);
+}
+
+static void test_connect() {
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.auto_pack = true, .socket_fastopen = 16});
+  server.on_session = [](const std::weak_ptr<tcp_session>& ws) {
+    ws.lock()->on_data = [ws](std::string data) {
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  // cached endpoints used without resolving: unreachable address first, happy eyeballs goes on to the next after delay
+  // fastopen is skipped for more than one endpoint, or the unreachable one would connect at once
+  {
+    auto key = detail::dns_cache::make_key("cached.invalid", PORT);
+    detail::dns_cache::instance().put(key, {asio::ip::tcp::endpoint(asio::ip::make_address("10.255.255.1"), PORT),
+                                            asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), PORT)});
+    asio::io_context context;
+    tcp_client client(context,
+                      tcp_config{.auto_pack = true, .dns_cache_ttl_ms = 10000, .happy_eyeballs_delay_ms = 50, .socket_fastopen_connect = true});
+    auto start = clock_type::now();
+    client.on_open = [&] {
+      LOG("happy eyeballs: %lld ms", (long long)std::chrono::duration_cast<std::chrono::milliseconds>(clock_type::now() - start).count());
+      ASSERT(client.remote_endpoint().address().to_string() == "127.0.0.1");
+      client.send("hello");
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(data == "hello");
+      client.stop();
+    };
+    client.on_open_failed = [](std::error_code ec) {
+      LOG("on_open_failed: %s", ec.message().c_str());
+      ASSERT(false);
+    };
+    client.open("cached.invalid", PORT);
+    client.run();
+  }
+
+  // all cached endpoints failed, resolve again next time
+  {
+    auto key = detail::dns_cache::make_key("dead.invalid", CLOSED_PORT);
+    detail::dns_cache::instance().put(key, {asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), CLOSED_PORT)});
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.dns_cache_ttl_ms = 10000});
+    bool failed = false;
+    client.on_open_failed = [&](std::error_code) {
+      failed = true;
+    };
+    client.open("dead.invalid", CLOSED_PORT);
+    context.run();
+    ASSERT(failed);
+    std::vector<asio::ip::tcp::endpoint> endpoints;
+    ASSERT(!detail::dns_cache::instance().get(key, std::chrono::milliseconds(10000), endpoints));
+  }
+
+  // tcp fastopen on client, first message rides on SYN once cookie cached by the first connection
+#ifdef __linux__
+  bool fastopen = fastopen_enabled();
+  if (!fastopen) LOG("net.ipv4.tcp_fastopen server side disabled, SYN data not checked");
+  for (int i = 0; i < 2; ++i) {
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.auto_pack = true, .socket_fastopen_connect = true});
+    client.on_open = [&] {
+      client.send("fastopen");
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(data == "fastopen");
+      auto info = client.tcp_info();
+      LOG("fastopen %d: syn_data: %d", i, info.syn_data);
+      if (fastopen && i == 1) ASSERT(info.syn_data);
+      client.stop();
+    };
+    client.open("127.0.0.1", PORT);
+    client.run();
+  }
+#endif
+
+  server_context.stop();
+  server_thread.join();
+}
+
+int main() {
+  LOG("test backoff");
+  test_backoff();
+  LOG("test jitter");
+  test_jitter();
+  LOG("test connect");
+  test_connect();
+  return EXIT_SUCCESS;
+}
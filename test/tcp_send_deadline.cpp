@@ -0,0 +1,79 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+  static const uint32_t test_count_max = 200;
+  static const uint32_t test_data_size = 1024 * 64;
+
+  // server: pause read for a while to make congestion
+  std::thread([] {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.auto_pack = true, .socket_recv_buffer_size = test_data_size});
+    asio::steady_timer resume_timer(context);
+    uint32_t recv_count = 0;
+    server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+      LOG("on_session:");
+      auto session = ws.lock();
+      session->pause_read();
+      resume_timer.expires_after(std::chrono::milliseconds(500));
+      resume_timer.async_wait([ws](const std::error_code&) {
+        LOG("session resume_read:");
+        ws.lock()->resume_read();
+      });
+      session->on_data = [&, ws](const std::string& data) {
+        if (data == "end") {
+          LOG("session recv: %u", recv_count);
+          ws.lock()->send(std::to_string(recv_count));
+        } else {
+          ASSERT(data.size() == test_data_size);
+          ++recv_count;
+        }
+      };
+    };
+    server.start(true);
+  }).detach();
+
+  // client
+  static std::atomic_bool pass_flag_expired{false};
+  std::thread([] {
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.auto_pack = true, .socket_send_buffer_size = test_data_size});
+    client.on_open = [&] {
+      LOG("client on_open:");
+      for (uint32_t i = 0; i < test_count_max; ++i) {
+        client.send(std::string(test_data_size, 'x'), std::chrono::milliseconds(100));
+      }
+      client.send("end");
+    };
+    client.on_data = [&](const std::string& data) {
+      auto recv_count = std::stoul(data);
+      auto& stats = client.stats();
+      LOG("client: recv: %lu, expired: %llu", recv_count, (unsigned long long)stats.send_expired_messages);
+      ASSERT(stats.send_expired_messages > 0);
+      ASSERT(stats.send_expired_bytes == stats.send_expired_messages * test_data_size);
+      ASSERT(recv_count + stats.send_expired_messages == test_count_max);
+      pass_flag_expired = true;
+      client.close();
+    };
+    client.on_close = [&] {
+      LOG("client on_close:");
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+
+  ASSERT(pass_flag_expired);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const char* ENDPOINT = "/tmp/foobar";
+const uint32_t CLIENT_NUM = 8;
+const uint32_t POOL_SIZE = 4;
+
+template <typename Server, typename Session, typename Client, typename Endpoint, typename Open>
+static void test_server(io_context_pool::strategy strategy, bool reuse_port, Endpoint endpoint, Open open) {
+  static std::mutex mutex;
+  static std::set<std::thread::id> session_threads;
+  session_threads.clear();
+  auto pool = std::make_shared<io_context_pool>(POOL_SIZE, strategy);
+  if (reuse_port) pool->set_cpu_affinity({0});
+
+  asio::io_context server_context;
+  Server server(server_context, endpoint, tcp_config{.auto_pack = true, .reuse_port = reuse_port});
+  server.set_io_context_pool(pool);
+  server.on_session = [](const std::weak_ptr<Session>& ws) {
+    auto session = ws.lock();
+    auto thread_id = std::this_thread::get_id();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      session_threads.insert(thread_id);
+    }
+    // handlers run on the io_context of session
+    ASSERT(session->get_io_context().get_executor().running_in_this_thread());
+    session->on_data = [ws, thread_id](std::string data) {
+      ASSERT(std::this_thread::get_id() == thread_id);
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  asio::io_context context;
+  std::vector<std::unique_ptr<Client>> clients;
+  uint32_t close_count = 0;
+  for (uint32_t i = 0; i < CLIENT_NUM; ++i) {
+    clients.emplace_back(std::make_unique<Client>(context, tcp_config{.auto_pack = true}));
+    auto& client = *clients.back();
+    client.on_open = [&client] {
+      client.send("hello");
+    };
+    client.on_data = [&client](const std::string& data) {
+      ASSERT(data == "hello");
+      client.close();
+    };
+    client.on_close = [&] {
+      if (++close_count == CLIENT_NUM) context.stop();
+    };
+    open(client);
+  }
+  context.run();
+
+  // all io_contexts of pool are used, reuse_port is spread by kernel hash
+  if (!reuse_port) {
+    ASSERT(session_threads.size() == POOL_SIZE);
+  }
+  // load released when session destroyed
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  uint32_t load = 0;
+  for (size_t i = 0; i < pool->size(); ++i) {
+    load += pool->load(i);
+  }
+  // pending accepts are not counted
+  ASSERT(load == 0);
+
+  server_context.stop();
+  server_thread.join();
+}
+
+/**
+ * pool shared by user outlives server, handler queued on pool thread should not touch the destroyed server
+ * with reuse_port, shard acceptors accept on the pool thread too
+ */
+static void test_destroy_with_shared_pool(bool reuse_port) {
+  static const uint32_t client_num = 8;
+  auto pool = std::make_shared<io_context_pool>(1);
+  pool->start();
+  auto block = [&pool] {
+    auto unblock = std::make_shared<std::promise<void>>();
+    asio::post(pool->get_io_context(0), [blocked = unblock->get_future().share()] {
+      blocked.wait();
+    });
+    return unblock;
+  };
+
+  asio::io_context client_context;
+  std::vector<asio::ip::tcp::socket> clients;
+  std::shared_ptr<std::promise<void>> second;
+  {
+    asio::io_context server_context;
+    tcp_server server(server_context, PORT, tcp_config{.reuse_port = reuse_port});
+    server.set_io_context_pool(pool);
+    server.on_session = [](const std::weak_ptr<tcp_session>&) {
+      ASSERT(false);
+    };
+    // accepts of shards are armed between the two blocks, and complete behind the second one
+    auto first = block();
+    server.start();
+    second = block();
+    for (uint32_t i = 0; i < client_num; ++i) {
+      clients.emplace_back(client_context);
+      clients.back().connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), PORT));
+    }
+    first->set_value();
+    server_context.run_for(std::chrono::milliseconds(100));
+  }
+  second->set_value();
+
+  // socket closed by the dropped handler or the closed acceptor
+  for (auto& client : clients) {
+    char data;
+    asio::error_code ec;
+    client.read_some(asio::buffer(&data, 1), ec);
+    ASSERT(ec == asio::error::eof || ec == asio::error::connection_reset);
+  }
+  pool->stop();
+}
+
+static void test_thread_option() {
+  auto cpus = detail::parse_cpu_list("0-3,8,10-11");
+  ASSERT((cpus == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  auto nodes = numa_nodes();
+  ASSERT(!nodes.empty() && numa_node_count() == (int)nodes.size());
+  LOG("numa nodes: %d, cpus of node %d: %zu", numa_node_count(), nodes[0], numa_node_cpus(nodes[0]).size());
+
+  // threads pinned to numa nodes, memory of sessions allocated on the pool thread
+  io_context_pool pool(2);
+  pool.set_numa_affinity();
+#ifdef __linux__
+  // first node with cpu, memory only nodes are skipped
+  auto first = std::find_if(nodes.begin(), nodes.end(), [](int node) {
+    return !numa_node_cpus(node).empty();
+  });
+  if (first != nodes.end()) ASSERT(pool.cpus(0) == numa_node_cpus(*first));
+  // kernel intersects affinity with cpuset of process, e.g. container runner
+  cpu_set_t process_set;
+  CPU_ZERO(&process_set);
+  sched_getaffinity(0, sizeof(process_set), &process_set);
+#endif
+  pool.start();
+  for (size_t i = 0; i < pool.size(); ++i) {
+    std::promise<std::vector<int>> affinity;
+    asio::post(pool.get_io_context(i), [&] {
+      std::vector<int> cpus;
+#ifdef __linux__
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+      }
+#endif
+      affinity.set_value(cpus);
+    });
+    auto actual = affinity.get_future().get();
+#ifdef __linux__
+    std::vector<int> expected;
+    for (int cpu : pool.cpus(i)) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &process_set)) expected.push_back(cpu);
+    }
+    // not pinned if no cpu of node is allowed
+    if (!expected.empty()) ASSERT(actual == expected);
+#endif
+  }
+  pool.stop();
+}
+
+int main() {
+  LOG("test thread option");
+  test_thread_option();
+
+  LOG("test destroy with shared pool");
+  test_destroy_with_shared_pool(false);
+#ifdef __linux__
+  test_destroy_with_shared_pool(true);
+#endif
+
+  LOG("test normal round_robin");
+  auto open = [](tcp_client& client) {
+    client.open("localhost", PORT);
+  };
+  test_server<tcp_server, tcp_session, tcp_client>(io_context_pool::strategy::round_robin, false, PORT, open);
+  LOG("test normal least_loaded");
+  test_server<tcp_server, tcp_session, tcp_client>(io_context_pool::strategy::least_loaded, false, PORT, open);
+#ifdef __linux__
+  LOG("test normal reuse_port");
+  test_server<tcp_server, tcp_session, tcp_client>(io_context_pool::strategy::round_robin, true, PORT, open);
+#endif
+
+  LOG("test domain");
+  ::unlink(ENDPOINT);
+  test_server<domain_tcp_server, domain_tcp_session, domain_tcp_client>(io_context_pool::strategy::round_robin, false, ENDPOINT,
+                                                                        [](domain_tcp_client& client) {
+                                                                          client.open(ENDPOINT);
+                                                                        });
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+  // server: max 2 connections, broadcast when sessions full
+  std::thread([] {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.auto_pack = true, .max_connections = 2});
+    uint32_t session_num = 0;
+    server.on_session = [&](const std::weak_ptr<tcp_session>&) {
+      LOG("on_session: count: %zu", server.session_count());
+      ASSERT(server.session_count() <= 2);
+      ASSERT(server.sessions().size() == server.session_count());
+      ++session_num;
+      if (session_num == 2) {
+        ASSERT(server.session_count() == 2);
+        server.broadcast("first");
+      } else if (session_num == 3) {
+        // third accepted after first closed
+        ASSERT(server.session_count() == 2);
+        server.broadcast("second");
+      }
+    };
+    server.start(true);
+  }).detach();
+
+  // clients: client 0 close after first broadcast, let client 2 in
+  std::thread([] {
+    asio::io_context context;
+    std::vector<std::unique_ptr<tcp_client>> clients;
+    std::vector<std::vector<std::string>> received(3);
+    uint32_t second_num = 0;
+    for (uint32_t i = 0; i < 3; ++i) {
+      clients.emplace_back(std::make_unique<tcp_client>(context, tcp_config{.auto_pack = true}));
+      auto client = clients.back().get();
+      client->on_data = [&, i, client](const std::string& data) {
+        LOG("client %u on_data: %s", i, data.c_str());
+        received[i].push_back(data);
+        if (data == "first" && i == 0) {
+          client->close();
+        } else if (data == "second" && ++second_num == 2) {
+          context.stop();
+        }
+      };
+      // connect in order
+      asio::post(context, [client] {
+        client->open("localhost", PORT);
+      });
+      context.run_for(std::chrono::milliseconds(50));
+    }
+    if (second_num < 2) {
+      context.restart();
+      context.run();
+    }
+    ASSERT(received[0] == std::vector<std::string>{"first"});
+    ASSERT(received[1] == (std::vector<std::string>{"first", "second"}));
+    ASSERT(received[2] == std::vector<std::string>{"second"});
+  }).join();
+  return EXIT_SUCCESS;
+}
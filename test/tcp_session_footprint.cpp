@@ -0,0 +1,142 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "asio_net/rpc_server.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+/**
+ * heap bytes alive, allocated by the thread with counting enabled
+ */
+static std::atomic<int64_t> alive_bytes{0};
+static thread_local bool counting = false;
+
+struct alignas(std::max_align_t) block_header {
+  size_t size;
+  bool counted;
+};
+
+void* operator new(size_t size) {
+  auto header = (block_header*)std::malloc(sizeof(block_header) + size);
+  if (!header) throw std::bad_alloc();
+  header->size = size;
+  header->counted = counting;
+  if (counting) alive_bytes += (int64_t)size;
+  return header + 1;
+}
+
+void operator delete(void* p) noexcept {
+  if (!p) return;
+  auto header = (block_header*)p - 1;
+  if (header->counted) alive_bytes -= (int64_t)header->size;
+  std::free(header);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+/**
+ * heap bytes per idle session, accepted and waiting for data, server objects included
+ */
+template <typename Server, typename Config>
+static int64_t test_idle_session(const char* name, Config config) {
+  static const uint32_t session_num = 100;
+
+  asio::io_context server_context;
+  Server server(server_context, PORT, config);
+  std::atomic<uint32_t> session_count{0};
+  server.on_session = [&](const auto&) {
+    session_count += 1;
+  };
+  server.start();
+  std::promise<int64_t> base;
+  std::thread server_thread([&] {
+    counting = true;
+    base.set_value(alive_bytes);
+    server_context.run();
+    counting = false;
+  });
+  int64_t base_bytes = base.get_future().get();
+
+  asio::io_context context;
+  std::vector<asio::ip::tcp::socket> clients;
+  for (uint32_t i = 0; i < session_num; ++i) {
+    clients.emplace_back(context);
+    clients.back().connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), PORT));
+  }
+  while (session_count != session_num) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  int64_t per_session = (alive_bytes - base_bytes) / session_num;
+  LOG("%s: %lld bytes per idle session", name, (long long)per_session);
+
+  clients.clear();
+  server_context.stop();
+  server_thread.join();
+  return per_session;
+}
+
+/**
+ * heap bytes per rpc_core::rpc set up like rpc_session does, the part of rpc session owned by the rpc_core submodule
+ */
+static int64_t test_rpc_core() {
+  static const uint32_t rpc_num = 100;
+  std::vector<std::shared_ptr<rpc_core::rpc>> rpcs;
+  rpcs.reserve(rpc_num);
+  counting = true;
+  int64_t base_bytes = alive_bytes;
+  for (uint32_t i = 0; i < rpc_num; ++i) {
+    auto rpc = rpc_core::rpc::create();
+    rpc->set_timer([](uint32_t, rpc_core::rpc::timeout_cb) {});
+    rpc->set_ready(true);
+    rpcs.push_back(std::move(rpc));
+  }
+  int64_t per_rpc = (alive_bytes - base_bytes) / rpc_num;
+  counting = false;
+  LOG("rpc_core: %lld bytes per rpc", (long long)per_rpc);
+  return per_rpc;
+}
+
+int main() {
+  // target of tcp_session, raw mode holds another read buffer of max_body_size
+  const int64_t target_bytes = 1024;
+  // target of rpc_session on top of tcp_session and rpc_core::rpc, whose size depends on the rpc_core submodule
+  const int64_t rpc_target_bytes = 512;
+  auto tcp = test_idle_session<tcp_server>("tcp", tcp_config{});
+  auto tcp_auto_pack = test_idle_session<tcp_server>("tcp auto_pack", tcp_config{.auto_pack = true});
+  auto tcp_lazy_read = test_idle_session<tcp_server>("tcp lazy_read", tcp_config{.lazy_read = true});
+  auto rpc_core = test_rpc_core();
+  auto rpc = test_idle_session<rpc_server>("rpc", rpc_config{}) - tcp_auto_pack - rpc_core;
+  auto rpc_ping = test_idle_session<rpc_server>("rpc ping", rpc_config{.ping_interval_ms = 60 * 1000}) - tcp_auto_pack - rpc_core;
+  LOG("rpc_session: %lld bytes, with ping: %lld bytes", (long long)rpc, (long long)rpc_ping);
+#ifdef __linux__
+  // allocation of std library and asio differs by platform
+  ASSERT(tcp < target_bytes + 1024);
+  ASSERT(tcp_auto_pack < target_bytes);
+  ASSERT(tcp_lazy_read < target_bytes);
+  ASSERT(rpc < rpc_target_bytes);
+  // ping timer and its pending wait
+  ASSERT(rpc_ping < rpc_target_bytes + 256);
+#else
+  (void)tcp;
+  (void)tcp_auto_pack;
+  (void)tcp_lazy_read;
+  (void)rpc;
+  (void)rpc_ping;
+  (void)target_bytes;
+  (void)rpc_target_bytes;
+#endif
+  return EXIT_SUCCESS;
+}
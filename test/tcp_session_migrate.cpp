@@ -0,0 +1,181 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+const uint32_t POOL_SIZE = 2;
+
+static size_t index_of(io_context_pool& pool, asio::io_context& context) {
+  for (size_t i = 0; i < pool.size(); ++i) {
+    if (&pool.get_io_context(i) == &context) return i;
+  }
+  return SIZE_MAX;
+}
+
+static void test_migrate() {
+  auto pool = std::make_shared<io_context_pool>(POOL_SIZE);
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.auto_pack = true});
+  server.set_io_context_pool(pool);
+  std::atomic<bool> migrated{false};
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    ws.lock()->on_data = [&, ws](std::string data) {
+      auto session = ws.lock();
+      ASSERT(session->get_io_context().get_executor().running_in_this_thread());
+      if (data != "migrate") {
+        ASSERT(migrated);
+        session->send(std::move(data));
+        return;
+      }
+      // not quiescent in on_data, move to the other io_context after read started, and reply while migrating
+      asio::post(session->get_executor(), [&, ws] {
+        auto session = ws.lock();
+        auto from = index_of(*pool, session->get_io_context());
+        auto to = (from + 1) % POOL_SIZE;
+        auto from_load = pool->load(from);
+        auto to_load = pool->load(to);
+        server.migrate(session, to, [&, ws, from, to, from_load, to_load](bool ok) {
+          ASSERT(ok);
+          auto session = ws.lock();
+          ASSERT(pool->get_io_context(to).get_executor().running_in_this_thread());
+          ASSERT(&session->get_io_context() == &pool->get_io_context(to));
+          // load moves with session, next accept may acquire one more meanwhile
+          ASSERT(pool->load(from) <= from_load);
+          ASSERT(pool->load(to) >= to_load + 1);
+          migrated = true;
+        });
+        ASSERT(session->is_migrating());
+        session->send("queued");
+      });
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  asio::io_context context;
+  tcp_client client(context, tcp_config{.auto_pack = true});
+  client.on_open = [&] {
+    client.send("migrate");
+  };
+  client.on_data = [&](const std::string& data) {
+    if (data == "queued") {
+      client.send("hello");
+    } else {
+      ASSERT(data == "hello");
+      client.close();
+    }
+  };
+  client.on_close = [&] {
+    context.stop();
+  };
+  client.open("localhost", PORT);
+  context.run();
+  ASSERT(migrated);
+
+  server_context.stop();
+  server_thread.join();
+}
+
+static void test_rebalance() {
+  const uint32_t CLIENT_NUM = 4;
+  const std::string HEAVY(16 * 1024, 'x');
+  // io_contexts of heavy sessions: first seen and last seen, outlive the server
+  std::mutex mutex;
+  std::map<const void*, std::pair<asio::io_context*, asio::io_context*>> heavy;
+  auto pool = std::make_shared<io_context_pool>(POOL_SIZE);
+  asio::io_context server_context;
+  tcp_server server(server_context, PORT, tcp_config{.auto_pack = true, .rebalance_interval_ms = 100, .rebalance_min_bytes = 64 * 1024});
+  server.set_io_context_pool(pool);
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    ws.lock()->on_data = [&, ws](std::string data) {
+      auto session = ws.lock();
+      auto current = &session->get_io_context();
+      ASSERT(current->get_executor().running_in_this_thread());
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = heavy.find(session.get());
+        if (it == heavy.end()) {
+          heavy[session.get()] = {current, current};
+        } else {
+          it->second.second = current;
+        }
+      }
+      session->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  // connect one by one, round_robin puts client 0 and 2 on the same io_context
+  asio::io_context context;
+  std::vector<std::unique_ptr<tcp_client>> clients;
+  for (uint32_t i = 0; i < CLIENT_NUM; ++i) {
+    clients.emplace_back(std::make_unique<tcp_client>(context, tcp_config{.auto_pack = true}));
+  }
+  for (uint32_t i = 0; i < CLIENT_NUM; ++i) {
+    auto& client = *clients[i];
+    client.on_open = [&, i] {
+      if (i + 1 < CLIENT_NUM) {
+        clients[i + 1]->open("localhost", PORT);
+        return;
+      }
+      // all connected, client 0 and 2 are heavy
+      clients[0]->send(HEAVY);
+      clients[2]->send(HEAVY);
+    };
+    client.on_data = [&client](std::string data) {
+      client.send(std::move(data));
+    };
+  }
+  clients[0]->open("localhost", PORT);
+  std::thread client_thread([&] {
+    context.run();
+  });
+
+  // one heavy session moved to the idle io_context
+  bool balanced = false;
+  for (int i = 0; i < 500 && !balanced; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (heavy.size() != 2) continue;
+    auto first = heavy.begin()->second;
+    auto second = (++heavy.begin())->second;
+    ASSERT(first.first == second.first);
+    balanced = first.second != second.second;
+  }
+  LOG("balanced: %d", balanced);
+  ASSERT(balanced);
+
+  context.stop();
+  client_thread.join();
+  server_context.stop();
+  server_thread.join();
+}
+
+int main() {
+#ifdef _WIN32
+  LOG("not supported");
+#else
+  LOG("test migrate");
+  test_migrate();
+  LOG("test rebalance");
+  test_rebalance();
+#endif
+  return EXIT_SUCCESS;
+}
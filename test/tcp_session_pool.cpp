@@ -0,0 +1,66 @@
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+int main() {
+  // pool: blocks reused, other sizes and overflow go to heap
+  {
+    auto pool = std::make_shared<detail::block_pool>(1);
+    auto a = detail::make_shared_pooled<std::string>(pool, "a");
+    auto b = detail::make_shared_pooled<std::string>(pool, "b");
+    auto* block_a = a.get();
+    a = nullptr;
+    b = nullptr;
+    ASSERT(pool->free_size() == 1);
+    auto c = detail::make_shared_pooled<std::string>(pool, "c");
+    ASSERT(c.get() == block_a && *c == "c");
+    ASSERT(pool->free_size() == 0);
+    auto d = detail::make_shared_pooled<std::array<char, 1024>>(pool);
+    d = nullptr;
+    ASSERT(pool->free_size() == 0);
+  }
+
+  // short connections one by one, session memory reused
+  asio::io_context context;
+  tcp_server server(context, PORT, tcp_config{.auto_pack = true, .session_pool_size = 4});
+  std::set<tcp_session*> sessions;
+  server.on_session = [&](const std::weak_ptr<tcp_session>& ws) {
+    auto session = ws.lock();
+    sessions.insert(session.get());
+    session->on_data = [ws](std::string data) {
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+
+  const int connection_num = 10;
+  for (int i = 0; i < connection_num; ++i) {
+    tcp_client client(context, tcp_config{.auto_pack = true});
+    bool received = false;
+    client.on_open = [&] {
+      client.send("hello");
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(data == "hello");
+      received = true;
+      client.close();
+    };
+    client.open("localhost", PORT);
+    while (!received || server.session_count() != 0) {
+      context.run_one_for(std::chrono::milliseconds(100));
+    }
+  }
+  LOG("connections: %d, session blocks: %zu", connection_num, sessions.size());
+  ASSERT(sessions.size() < (size_t)connection_num);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+#ifdef __linux__
+/**
+ * find socket of this process by its local and peer port, channels not expose their socket
+ */
+static int find_socket(uint16_t local_port, uint16_t peer_port) {
+  for (int fd = 0; fd < 1024; ++fd) {
+    sockaddr_in local{}, peer{};
+    socklen_t local_len = sizeof(local), peer_len = sizeof(peer);
+    if (getsockname(fd, (sockaddr*)&local, &local_len) != 0 || local.sin_family != AF_INET) continue;
+    if (getpeername(fd, (sockaddr*)&peer, &peer_len) != 0) continue;
+    if (ntohs(local.sin_port) == local_port && ntohs(peer.sin_port) == peer_port) return fd;
+  }
+  return -1;
+}
+
+static int get_option(int fd, int level, int name) {
+  int value = -1;
+  socklen_t len = sizeof(value);
+  ASSERT(getsockopt(fd, level, name, &value, &len) == 0);
+  return value;
+}
+
+/**
+ * options really applied to sockets, failures are only logged by the library
+ */
+static void check_applied(uint16_t client_port) {
+  int client_fd = find_socket(client_port, PORT);
+  int session_fd = find_socket(PORT, client_port);
+  ASSERT(client_fd >= 0 && session_fd >= 0);
+
+  // client: bulk profile, keepalive and buffer sizes, kernel doubles the buffer sizes
+  ASSERT(get_option(client_fd, IPPROTO_TCP, TCP_NODELAY) == 0);
+  ASSERT(get_option(client_fd, IPPROTO_IP, IP_TOS) == 0x08);
+  ASSERT(get_option(client_fd, SOL_SOCKET, SO_KEEPALIVE) == 1);
+  ASSERT(get_option(client_fd, IPPROTO_TCP, TCP_KEEPIDLE) == 10);
+  ASSERT(get_option(client_fd, IPPROTO_TCP, TCP_KEEPINTVL) == 5);
+  ASSERT(get_option(client_fd, IPPROTO_TCP, TCP_KEEPCNT) == 3);
+  ASSERT(get_option(client_fd, SOL_SOCKET, SO_SNDBUF) >= 64 * 1024);
+  ASSERT(get_option(client_fd, SOL_SOCKET, SO_RCVBUF) >= 64 * 1024);
+
+  // session: low_latency profile
+  ASSERT(get_option(session_fd, IPPROTO_TCP, TCP_NODELAY) == 1);
+  ASSERT(get_option(session_fd, IPPROTO_IP, IP_TOS) == 0x10);
+  ASSERT(get_option(session_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT) == 16 * 1024);
+  ASSERT(get_option(session_fd, SOL_SOCKET, SO_KEEPALIVE) == 0);
+  LOG("options applied: client fd: %d, session fd: %d", client_fd, session_fd);
+}
+#endif
+
+int main() {
+  // profile only fill the options not set
+  {
+    tcp_config config{.profile = tcp_profile::low_latency, .socket_busy_poll_us = 0};
+    config.init();
+    ASSERT(config.socket_nodelay == 1);
+    ASSERT(config.socket_quickack == 1);
+    ASSERT(config.socket_busy_poll_us == 0);
+    ASSERT(config.socket_congestion.empty());
+  }
+  {
+    tcp_config config{.profile = tcp_profile::bulk};
+    config.init();
+    ASSERT(config.socket_nodelay == 0);
+    ASSERT(config.socket_congestion == "bbr");
+  }
+  {
+    rpc_config config{.profile = tcp_profile::bulk, .socket_congestion = "cubic", .socket_keepalive = 1};
+    auto tc = config.to_tcp_config();
+    tc.init();
+    ASSERT(tc.profile == tcp_profile::bulk);
+    ASSERT(tc.socket_congestion == "cubic");
+    ASSERT(tc.socket_keepalive == 1);
+  }
+  {
+    // read and shaping options reach rpc
+    rpc_config config{.accept_retry_max_ms = 500, .lazy_read = true, .read_budget_messages = 16, .send_rate_limit = 1024};
+    config.shared_recv_bucket = std::make_shared<token_bucket>(1024, 1024);
+    auto tc = config.to_tcp_config();
+    ASSERT(tc.accept_retry_max_ms == 500);
+    ASSERT(tc.lazy_read);
+    ASSERT(tc.read_budget_messages == 16);
+    ASSERT(tc.send_rate_limit == 1024);
+    ASSERT(tc.shared_recv_bucket == config.shared_recv_bucket);
+  }
+
+  // options applied to session and client, unsupported options are ignored
+  std::thread([] {
+    asio::io_context context;
+    tcp_server server(context, PORT, tcp_config{.auto_pack = true, .profile = tcp_profile::low_latency});
+    server.on_session = [](const std::weak_ptr<tcp_session>& ws) {
+      LOG("on_session:");
+      auto session = ws.lock();
+      session->on_data = [ws](std::string data) {
+        ws.lock()->send(std::move(data));
+      };
+    };
+    server.start(true);
+  }).detach();
+
+  std::thread([] {
+    asio::io_context context;
+    tcp_client client(context, tcp_config{.auto_pack = true,
+                                          .socket_send_buffer_size = 64 * 1024,
+                                          .socket_recv_buffer_size = 64 * 1024,
+                                          .profile = tcp_profile::bulk,
+                                          .socket_keepalive = 1,
+                                          .socket_keepalive_idle_s = 10,
+                                          .socket_keepalive_interval_s = 5,
+                                          .socket_keepalive_count = 3});
+    client.on_open = [&] {
+      LOG("client on_open:");
+      client.send("hello");
+    };
+    client.on_data = [&](const std::string& data) {
+      ASSERT(data == "hello");
+#ifdef __linux__
+      check_applied(client.local_endpoint().port());
+#endif
+      client.close();
+    };
+    client.on_close = [&] {
+      LOG("client on_close:");
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+  return EXIT_SUCCESS;
+}
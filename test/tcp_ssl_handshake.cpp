@@ -0,0 +1,149 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+static void init_server_context(asio::ssl::context& ssl_context) {
+  ssl_context.set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 | asio::ssl::context::single_dh_use);
+  ssl_context.set_password_callback([](std::size_t size, asio::ssl::context_base::password_purpose purpose) {
+    (void)(size);
+    (void)(purpose);
+    return "test";
+  });
+  ssl_context.use_certificate_chain_file(OPENSSL_PEM_PATH "server.pem");
+  ssl_context.use_private_key_file(OPENSSL_PEM_PATH "server.pem", asio::ssl::context::pem);
+  ssl_context.use_tmp_dh_file(OPENSSL_PEM_PATH "dh4096.pem");
+}
+
+template <typename Pred>
+static void wait_until(Pred pred) {
+  for (int i = 0; i < 500 && !pred(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT(pred());
+}
+
+/**
+ * sessions in handshake are counted by max_connections, the slot is released when handshake failed
+ */
+static void test_max_connections() {
+  asio::io_context server_context;
+  asio::ssl::context server_ssl_context(asio::ssl::context::sslv23);
+  init_server_context(server_ssl_context);
+  tcp_server_ssl server(server_context, PORT, server_ssl_context, tcp_config{.max_connections = 1});
+  std::atomic<int> handshake_errors{0};
+  server.on_handshake_error = [&](std::error_code) {
+    handshake_errors += 1;
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  // never sends client hello, holds the only slot
+  asio::io_context context;
+  asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), PORT);
+  asio::ip::tcp::socket idle(context);
+  idle.connect(endpoint);
+  wait_until([&] {
+    return server.session_count() == 1;
+  });
+  ASSERT(server.sessions().empty());
+
+  // waits in backlog, accepted after the idle one failed
+  asio::ip::tcp::socket waiting(context);
+  waiting.connect(endpoint);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT(server.session_count() == 1);
+  idle.close();
+  wait_until([&] {
+    return handshake_errors == 1 && server.session_count() == 1;
+  });
+  waiting.close();
+  wait_until([&] {
+    return handshake_errors == 2 && server.session_count() == 0;
+  });
+
+  server_context.stop();
+  server_thread.join();
+}
+
+int main() {
+  test_max_connections();
+
+  // server: handshakes on a pool, sessions on server io_context, close session on "close"
+  asio::io_context server_context;
+  asio::ssl::context server_ssl_context(asio::ssl::context::sslv23);
+  init_server_context(server_ssl_context);
+  tcp_server_ssl server(server_context, PORT, server_ssl_context, tcp_config{.auto_pack = true, .ssl_session_resumption = true});
+  server.set_handshake_pool(std::make_shared<io_context_pool>(1));
+  std::atomic<std::thread::id> server_thread_id;
+  std::atomic<int> server_reused{0};
+  server.on_session = [&](const std::weak_ptr<tcp_session_ssl>& ws) {
+    // handed back to io_context of session after handshake
+    ASSERT(std::this_thread::get_id() == server_thread_id);
+    auto session = ws.lock();
+    if (session->ssl_session_reused()) server_reused += 1;
+    session->on_data = [ws](std::string data) {
+      if (data == "close") {
+        ws.lock()->close();
+      } else {
+        ws.lock()->send(std::move(data));
+      }
+    };
+  };
+  server.on_handshake_error = [](std::error_code ec) {
+    LOGE("on_handshake_error: %d, %s", ec.value(), ec.message().c_str());
+    ASSERT(false);
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_thread_id = std::this_thread::get_id();
+    server_context.run();
+  });
+
+  // client: full handshake first, then resume the session on each reconnect
+  asio::io_context context;
+  asio::ssl::context ssl_context(asio::ssl::context::sslv23);
+  ssl_context.load_verify_file(OPENSSL_PEM_PATH "ca.pem");
+  tcp_client_ssl client(context, ssl_context, tcp_config{.auto_pack = true, .ssl_session_resumption = true});
+  int open_count = 0;
+  client.on_open = [&] {
+    LOG("open: %d, reused: %d", open_count, client.ssl_session_reused());
+    ASSERT(client.ssl_session_reused() == (open_count != 0));
+    ++open_count;
+    client.send("hello");
+  };
+  client.on_data = [&](const std::string& data) {
+    ASSERT(data == "hello");
+    // session ticket of tls 1.3 arrives after handshake, read before close
+    if (open_count < 3) {
+      client.send("close");
+    } else {
+      client.stop();
+    }
+  };
+  client.on_open_failed = [](std::error_code ec) {
+    LOGE("on_open_failed: %s", ec.message().c_str());
+    ASSERT(false);
+  };
+  client.set_reconnect(10);
+  client.open("localhost", PORT);
+  client.run();
+  ASSERT(open_count == 3);
+
+  server_context.stop();
+  server_thread.join();
+  ASSERT(server_reused == 2);
+  return EXIT_SUCCESS;
+}
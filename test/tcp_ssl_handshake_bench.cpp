@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "asio_net/tcp_client.hpp"
+#include "asio_net/tcp_server.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+static void init_server_context(asio::ssl::context& ssl_context) {
+  ssl_context.set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 | asio::ssl::context::single_dh_use);
+  ssl_context.set_password_callback([](std::size_t size, asio::ssl::context_base::password_purpose purpose) {
+    (void)(size);
+    (void)(purpose);
+    return "test";
+  });
+  ssl_context.use_certificate_chain_file(OPENSSL_PEM_PATH "server.pem");
+  ssl_context.use_private_key_file(OPENSSL_PEM_PATH "server.pem", asio::ssl::context::pem);
+  ssl_context.use_tmp_dh_file(OPENSSL_PEM_PATH "dh4096.pem");
+}
+
+/**
+ * reconnect storm: client threads handshake, send one byte and wait the echo, then reset
+ * report handshakes per second, and echo latency of an established session on the server io_context meanwhile
+ */
+static void test_handshake_rate(const char* name, size_t handshake_pool_size, bool resumption) {
+  static const uint32_t client_thread_num = 4;
+  static const auto duration = std::chrono::seconds(1);
+
+  std::atomic<uint32_t> handshakes{0};
+  std::atomic<uint32_t> resumed{0};
+  asio::io_context server_context;
+  asio::ssl::context server_ssl_context(asio::ssl::context::sslv23);
+  init_server_context(server_ssl_context);
+  tcp_server_ssl server(server_context, PORT, server_ssl_context, tcp_config{.ssl_session_resumption = resumption});
+  if (handshake_pool_size) {
+    server.set_handshake_pool(std::make_shared<io_context_pool>(handshake_pool_size));
+  }
+  server.on_session = [&](const std::weak_ptr<tcp_session_ssl>& ws) {
+    handshakes += 1;
+    auto session = ws.lock();
+    if (session->ssl_session_reused()) resumed += 1;
+    session->on_data = [ws](std::string data) {
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+  std::thread server_thread([&] {
+    server_context.run();
+  });
+
+  // probe: ping-pong on an established session
+  std::mutex mutex;
+  std::vector<int64_t> latencies;
+  asio::io_context probe_context;
+  asio::ssl::context probe_ssl_context(asio::ssl::context::sslv23);
+  tcp_client_ssl probe(probe_context, probe_ssl_context);
+  auto start = std::chrono::steady_clock::now();
+  probe.on_open = [&] {
+    start = std::chrono::steady_clock::now();
+    probe.send("p");
+  };
+  probe.on_data = [&](const std::string&) {
+    auto now = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - start).count());
+    }
+    start = now;
+    probe.send("p");
+  };
+  probe.open("127.0.0.1", PORT);
+  std::thread probe_thread([&] {
+    probe.run();
+  });
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!latencies.empty()) {
+      latencies.clear();
+      break;
+    }
+  }
+  auto probe_handshakes = handshakes.load();
+
+  std::atomic_bool running{true};
+  std::vector<std::thread> client_threads;
+  for (uint32_t i = 0; i < client_thread_num; ++i) {
+    client_threads.emplace_back([&] {
+      asio::io_context context;
+      asio::ssl::context ssl_context(asio::ssl::context::sslv23);
+      asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), PORT);
+      std::shared_ptr<SSL_SESSION> session;
+      while (running) {
+        asio::ssl::stream<asio::ip::tcp::socket> stream(context, ssl_context);
+        asio::error_code ec;
+        stream.lowest_layer().connect(endpoint, ec);
+        if (ec) continue;
+        if (session) SSL_set_session(stream.native_handle(), session.get());
+        stream.handshake(asio::ssl::stream_base::client, ec);
+        char byte = 'x';
+        if (!ec) asio::write(stream, asio::buffer(&byte, 1), ec);
+        // session ticket of tls 1.3 arrives before the echo
+        if (!ec) asio::read(stream, asio::buffer(&byte, 1), ec);
+        if (!ec && resumption) session.reset(SSL_get1_session(stream.native_handle()), SSL_SESSION_free);
+        // reset instead of close, avoid TIME_WAIT exhaust local ports, and keep the session resumable
+        SSL_set_shutdown(stream.native_handle(), SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        stream.lowest_layer().set_option(asio::socket_base::linger(true, 0), ec);
+        stream.lowest_layer().close(ec);
+      }
+    });
+  }
+
+  std::this_thread::sleep_for(duration);
+  uint32_t count = handshakes - probe_handshakes;
+  running = false;
+  for (auto& t : client_threads) t.join();
+  probe_context.stop();
+  probe_thread.join();
+  server_context.stop();
+  server_thread.join();
+
+  ASSERT(count > 0);
+  std::sort(latencies.begin(), latencies.end());
+  auto p99 = latencies.empty() ? 0 : latencies[std::min(latencies.size() * 99 / 100, latencies.size() - 1)];
+  LOG("%s: handshakes: %u/s, resumed: %u, established echo: %zu, p99: %lldus", name,
+      (uint32_t)(count / std::chrono::duration_cast<std::chrono::duration<double>>(duration).count()), resumed.load(), latencies.size(),
+      (long long)p99);
+}
+
+int main() {
+  size_t pool_size = std::max(std::thread::hardware_concurrency() / 2, 1u);
+  test_handshake_rate("inline", 0, false);
+  test_handshake_rate("handshake pool", pool_size, false);
+  test_handshake_rate("inline + resumption", 0, true);
+  test_handshake_rate("handshake pool + resumption", pool_size, true);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "asio_net/striped_client.hpp"
+#include "asio_net/striped_server.hpp"
+#include "asio_net/tcp_client.hpp"
+#include "assert_def.h"
+#include "log.h"
+
+using namespace asio_net;
+
+const uint16_t PORT = 6666;
+
+static std::string make_data(size_t size, uint32_t seed) {
+  std::string data;
+  data.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = (char)(i * 31 + seed);
+  }
+  return data;
+}
+
+static void test_echo() {
+  static const std::vector<size_t> test_sizes = {0, 1, 1023, 1024, 1025, 4096, 1024 * 1024 * 4};
+  static const striped_config config{.stripe_num = 4, .chunk_size = 1024};
+
+  // server
+  static std::atomic_bool pass_flag_session_close{false};
+  std::thread([] {
+    asio::io_context context;
+    striped_server server(context, PORT, config);
+    server.on_session = [&](const std::weak_ptr<striped_session>& ws) {
+      LOG("on_session:");
+      auto session = ws.lock();
+      ASSERT(session->is_open());
+      ASSERT(session->stripe_num() == config.stripe_num);
+      session->on_close = [&] {
+        LOG("session on_close:");
+        pass_flag_session_close = true;
+        context.stop();
+      };
+      session->on_data = [ws](std::string data) {
+        ASSERT(!ws.expired());
+        ws.lock()->send(data);
+      };
+    };
+    server.start(true);
+  }).detach();
+
+  // client
+  static std::atomic_bool pass_flag_client_close{false};
+  std::thread([] {
+    asio::io_context context;
+    striped_client client(context, config);
+    uint32_t test_count_expect = 0;
+    client.on_open = [&] {
+      LOG("client on_open:");
+      ASSERT(client.is_open());
+      for (uint32_t i = 0; i < test_sizes.size(); ++i) {
+        client.send(make_data(test_sizes[i], i));
+      }
+    };
+    client.on_data = [&](const std::string& data) {
+      LOG("client on_data: size: %zu", data.size());
+      ASSERT(data == make_data(test_sizes[test_count_expect], test_count_expect));
+      if (++test_count_expect == test_sizes.size()) {
+        client.close();
+      }
+    };
+    client.on_close = [&] {
+      LOG("client on_close:");
+      pass_flag_client_close = true;
+      client.stop();
+    };
+    client.open("localhost", PORT);
+    client.run();
+  }).join();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT(pass_flag_session_close);
+  ASSERT(pass_flag_client_close);
+}
+
+static std::string make_chunk(uint64_t seq, bool last, size_t size) {
+  std::string frame;
+  frame.resize(striped_session::chunk_header_size + size, 'x');
+  frame[0] = (char)striped_session::frame_chunk;
+  std::memcpy(&frame[1], &seq, sizeof(seq));
+  frame[9] = (char)(last ? 1 : 0);
+  return frame;
+}
+
+/**
+ * raw stripe sends hello and then frames break the reassembly limits, server must close the session
+ */
+static void test_recv_limit(const char* name, std::vector<std::string> frames) {
+  LOG("test_recv_limit: %s", name);
+  static const striped_config config{.stripe_num = 1, .chunk_size = 1024, .recv_window = 4, .max_recv_buffer = 4096, .max_message_size = 8192};
+  asio::io_context context;
+  striped_server server(context, PORT, config);
+  bool session_closed = false;
+  server.on_session = [&](const std::weak_ptr<striped_session>& ws) {
+    auto session = ws.lock();
+    session->on_data = [](const std::string&) {
+      ASSERT(false);
+    };
+    session->on_close = [&] {
+      session_closed = true;
+      context.stop();
+    };
+  };
+  server.start();
+
+  tcp_client client(context, tcp_config{.auto_pack = true});
+  client.on_open = [&] {
+    client.send(striped_session::make_hello(1, 1, 0));
+    for (auto& frame : frames) {
+      client.send(frame);
+    }
+  };
+  client.open("localhost", PORT);
+  context.run();
+  ASSERT(session_closed);
+}
+
+/**
+ * striped_client opens again after closed, as a new session
+ */
+static void test_reopen() {
+  static const striped_config config{.stripe_num = 2, .chunk_size = 4};
+  asio::io_context context;
+  striped_server server(context, PORT, config);
+  uint32_t session_count = 0;
+  server.on_session = [&](const std::weak_ptr<striped_session>& ws) {
+    ++session_count;
+    ws.lock()->on_data = [ws](std::string data) {
+      ws.lock()->send(std::move(data));
+    };
+  };
+  server.start();
+
+  striped_client client(context, config);
+  uint32_t open_count = 0;
+  client.on_open = [&] {
+    ++open_count;
+    client.send("hello striped " + std::to_string(open_count));
+  };
+  client.on_data = [&](const std::string& data) {
+    ASSERT(data == "hello striped " + std::to_string(open_count));
+    client.close();
+  };
+  client.on_close = [&] {
+    if (open_count == 2) {
+      context.stop();
+      return;
+    }
+    asio::post(context, [&] {
+      client.open("localhost", PORT);
+    });
+  };
+  client.open("localhost", PORT);
+  context.run();
+  ASSERT(open_count == 2);
+  ASSERT(session_count == 2);
+}
+
+int main() {
+  test_echo();
+  test_recv_limit("out of window", {make_chunk(1ull << 40, true, 1)});
+  test_recv_limit("recv buffer", {make_chunk(1, true, 2048), make_chunk(2, true, 2048)});
+  test_recv_limit("message size", {make_chunk(0, false, 3000), make_chunk(1, false, 3000), make_chunk(2, true, 3000)});
+  test_recv_limit("duplicate", {make_chunk(1, true, 1), make_chunk(1, true, 1)});
+  test_reopen();
+  return EXIT_SUCCESS;
+}